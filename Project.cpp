@@ -9,6 +9,17 @@ int main()
 	const int numberOfBots = { 50 };
 	const int arenaWidth = { 8 };
 	const int arenaHeight = { 8 };
+	const DispatchMode dispatchMode = { DispatchMode::Virtual };
+	const SimulationMode simulationMode = { SimulationMode::Threaded };
+	const MoveMode moveMode = { MoveMode::Locked };
+	const VisionMode visionMode = { VisionMode::Global }; // Limited plays with fog of war
+	const InteractionMode interactionMode = { InteractionMode::Direct }; // Mailbox sends attacks and buff expiries as messages - not in lockstep
+	const bool pinThreads = { false }; // Pin bot threads and combat workers to the available CPUs
+	const int itemSpawnRounds = { 5 };
+	const int schedulerThreads = { 4 }; // Scheduled mode only
+	const std::vector<int> factionSizes = {}; // Team sizes adding up to numberOfBots, e.g. { 25, 25 } - empty for free-for-all
+	const bool publishFeed = { false }; // Publish frames to shared memory for Viewer processes
+	const bool exportMetrics = { false }; // Write live metrics in the Prometheus text format every second
 
 	const int mainSleepMillis = arenaWidth * arenaHeight * 20;
 
@@ -21,30 +32,75 @@ int main()
 	std::uniform_int_distribution<> distribItemType(0, static_cast<int>(ItemType::Count) - 1);
 
 	Arena arena(arenaWidth, arenaHeight, numberOfBots, numberOfItems);
+	arena.setDispatchMode(dispatchMode);
+	arena.setMoveMode(moveMode);
+	arena.setVisionMode(visionMode);
+	arena.setInteractionMode(interactionMode);
+
+	if (!factionSizes.empty() && !arena.setFactions(factionSizes))
+		return 1;
+
+	std::vector<int> cpus = getAvailableCpus();
+	if (pinThreads)
+		arena.setWorkerCpus(cpus);
+
+	// Viewers attach with: Viewer arenaFeed [render | stats]
+	std::optional<StateFeedPublisher> feed;
+	if (publishFeed)
+		feed.emplace(arena, defaultStateFeed);
+
+	// Scrapes go to arenaMetrics.prom - point a node exporter textfile collector at it for long runs
+	std::vector<GaugeRegistration> gauges;
+	std::optional<MetricsExporter> metrics;
+	if (exportMetrics)
+	{
+		gauges.push_back(getMetrics().gauge("arena_bots", "Bots in the arena", [&arena] { return arena.getNumOfBots(); }));
+		gauges.push_back(getMetrics().gauge("arena_items", "Items in the latest snapshot", [&arena] { return arena.getSnapshot()->items.size(); }));
+		gauges.push_back(getMetrics().gauge("arena_snapshot_version", "Version of the latest snapshot", [&arena] { return arena.getSnapshot()->version; }));
+		metrics.emplace(defaultMetricsFile);
+	}
+
 	arena.displayArena();
 
-	// Main thread is responsible for starting arena loop and threads
 	std::vector<std::thread> botThreads;
-	for (int i = 0; i < numberOfBots; i++) 
+
+	if (simulationMode == SimulationMode::Lockstep)
 	{
-		botThreads.emplace_back(&Arena::runBot, &arena, i);
+		// Whole rounds are played on the main thread, combat is resolved in parallel batches
+		arena.runLockstep(itemSpawnRounds);
 	}
-
-	// Sleep main thread
-	std::this_thread::sleep_for(std::chrono::milliseconds(mainSleepMillis));
-
-	while (true) 
+	else if (simulationMode == SimulationMode::Scheduled)
 	{
-		int x = distribWidth(gen);
-		int y = distribHeight(gen);
-		ItemType type = static_cast<ItemType>(distribItemType(gen));
-		arena.spawnItem(x, y, type);
+		// Bot turns and item spawns are timers, run by a few scheduler threads instead of a thread per bot
+		arena.runScheduled(schedulerThreads, mainSleepMillis);
+	}
+	else
+	{
+		// Main thread is responsible for starting arena loop and threads
+		for (BotHandle handle : arena.getBotHandles()) 
+		{
+			botThreads.emplace_back(&Arena::runBot, &arena, handle);
+
+			if (pinThreads)
+				pinThread(botThreads.back(), cpus[botThreads.size() % cpus.size()]);
+		}
 
-		if (arena.getNumOfBots() <= 1) 
-			break;
-		
 		// Sleep main thread
 		std::this_thread::sleep_for(std::chrono::milliseconds(mainSleepMillis));
+
+		while (true) 
+		{
+			int x = distribWidth(gen);
+			int y = distribHeight(gen);
+			ItemType type = static_cast<ItemType>(distribItemType(gen));
+			arena.spawnItem(x, y, type);
+
+			if (arena.getNumOfBots() <= 1) 
+				break;
+		
+			// Sleep main thread
+			std::this_thread::sleep_for(std::chrono::milliseconds(mainSleepMillis));
+		}
 	}
 
 	// Join all bot threads
@@ -56,6 +112,14 @@ int main()
 		}
 	}
 
+	// The final frame stays readable until the publisher is destroyed
+	if (feed)
+		feed->stop();
+
+	// The last scrape has the final totals
+	if (metrics)
+		metrics->stop();
+
 	// Writing execution and waiting time for each thread to a file
 	auto threadWaitTimeMap = arena.getThreadWaitTimeMap();
 	auto threadExecutionTimeMap = arena.getThreadExecutionTimeMap();
@@ -98,6 +162,16 @@ int main()
 		std::cerr << "Error writing to file: " << e.what() << std::endl;
 	}
 
+	// What the bots did with their turns - archetype totals here, every bot in the report
+	std::vector<BotActivityRecord> activity = arena.getBotActivity();
+	const std::string activityFilename = "botActivity.json";
+
+	printActivitySummary(activity);
+	if (writeActivityReport(activity, activityFilename))
+		std::cout << "Bot activity written to " << activityFilename << std::endl;
+	else
+		std::cerr << "Failed to open " << activityFilename << std::endl;
+
 	std::cout << "Finished running arena loop." << std::endl;
 
 	return 0;
@@ -7,9 +7,14 @@
 #include <thread>
 #include <chrono>
 #include <fstream>
+#include <optional>
 
 // TODO: Reference additional headers your program requires here.
 #include "item.h"
 #include "bot.h"
 #include "arena.h"
-#include "utils.h"
\ No newline at end of file
+#include "utils.h"
+#include "cpuAffinity.h"
+#include "stateFeed.h"
+#include "activityReport.h"
+#include "metrics.h"
\ No newline at end of file
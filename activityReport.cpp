@@ -0,0 +1,113 @@
+#include "activityReport.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <format>
+
+ActivityTotals summarizeActivity(const std::vector<BotActivityRecord>& records)
+{
+	ActivityTotals totals{};
+	for (const BotActivityRecord& record : records) {
+		ArchetypeActivity& archetype = totals[static_cast<size_t>(record.archetype)];
+		archetype.bots++;
+		archetype.activity.merge(record.activity);
+	}
+
+	return totals;
+}
+
+std::optional<double> getLocksPerUsefulAction(const BotActivity& activity)
+{
+	uint64_t useful = activity.getUsefulActions();
+	if (useful == 0 || activity.lockAcquisitions == 0)
+		return std::nullopt;
+
+	return static_cast<double>(activity.lockAcquisitions) / useful;
+}
+
+void printActivitySummary(const std::vector<BotActivityRecord>& records)
+{
+	const int width = 16;
+	ActivityTotals totals = summarizeActivity(records);
+
+	std::cout << std::left << std::setw(width) << "Archetype"
+		<< std::setw(width) << "Bots"
+		<< std::setw(width) << "Turns"
+		<< std::setw(width) << "Idle Turns %"
+		<< std::setw(width) << "Moves"
+		<< std::setw(width) << "Failed Moves"
+		<< std::setw(width) << "Empty Checks"
+		<< std::setw(width) << "Attacks"
+		<< std::setw(width) << "Pickups"
+		<< std::setw(width) << "Locks/Action" << "\n";
+
+	for (size_t i = 0; i < totals.size(); i++) {
+		const BotActivity& activity = totals[i].activity;
+		double idleShare = activity.turns > 0 ? 100.0 * activity.idleTurns / activity.turns : 0.0;
+		std::optional<double> locksPerAction = getLocksPerUsefulAction(activity);
+
+		std::cout << std::setw(width) << archetypeStats[i].name
+			<< std::setw(width) << totals[i].bots
+			<< std::setw(width) << activity.turns
+			<< std::setw(width) << std::fixed << std::setprecision(1) << idleShare
+			<< std::setw(width) << activity.moves
+			<< std::setw(width) << activity.getFailedMoves()
+			<< std::setw(width) << activity.emptyBattleChecks
+			<< std::setw(width) << activity.attacks
+			<< std::setw(width) << activity.pickups
+			<< std::setw(width) << (locksPerAction ? std::format("{:.2f}", *locksPerAction) : "-") << "\n";
+	}
+}
+
+// The counters of one bot or group as JSON members, without the braces
+static std::string formatActivity(const BotActivity& activity)
+{
+	std::optional<double> locksPerAction = getLocksPerUsefulAction(activity);
+
+	std::string failedMoves;
+	for (size_t i = 0; i < activity.failedMoves.size(); i++)
+		failedMoves += std::format("{}\"{}\": {}", i > 0 ? ", " : "", moveFailureNames[i], activity.failedMoves[i]);
+
+	return std::format("\"turns\": {}, \"idleTurns\": {}, \"moves\": {}, \"failedMoves\": {{ {} }}, \"skills\": {}, "
+		"\"emptyBattleChecks\": {}, \"attacks\": {}, \"pickups\": {}, \"usefulActions\": {}, "
+		"\"lockAcquisitions\": {}, \"idleLockAcquisitions\": {}, \"lockWaitSeconds\": {:.6f}, \"locksPerUsefulAction\": {}",
+		activity.turns, activity.idleTurns, activity.moves, failedMoves, activity.skills,
+		activity.emptyBattleChecks, activity.attacks, activity.pickups, activity.getUsefulActions(),
+		activity.lockAcquisitions, activity.idleLockAcquisitions, activity.lockWaitSeconds,
+		locksPerAction ? std::format("{:.3f}", *locksPerAction) : "null");
+}
+
+bool writeActivityReport(const std::vector<BotActivityRecord>& records, const std::string& filename)
+{
+	std::ofstream outFile(filename, std::ios::out | std::ios::trunc);
+	if (!outFile.is_open())
+		return false;
+
+	ActivityTotals totals = summarizeActivity(records);
+	BotActivity game;
+	for (const ArchetypeActivity& archetype : totals)
+		game.merge(archetype.activity);
+
+	outFile << "{\n";
+	outFile << std::format("  \"total\": {{ \"bots\": {}, {} }},\n", records.size(), formatActivity(game));
+
+	outFile << "  \"archetypes\": [\n";
+	for (size_t i = 0; i < totals.size(); i++) {
+		outFile << std::format("    {{ \"archetype\": \"{}\", \"bots\": {}, {} }}{}\n",
+			archetypeStats[i].name, totals[i].bots, formatActivity(totals[i].activity), i + 1 < totals.size() ? "," : "");
+	}
+	outFile << "  ],\n";
+
+	outFile << "  \"bots\": [\n";
+	for (size_t i = 0; i < records.size(); i++) {
+		const BotActivityRecord& record = records[i];
+		outFile << std::format("    {{ \"id\": {}, \"archetype\": \"{}\", \"faction\": {}, \"survived\": {}, {} }}{}\n",
+			record.id, getArchetypeStats(record.archetype).name, record.faction, record.survived,
+			formatActivity(record.activity), i + 1 < records.size() ? "," : "");
+	}
+	outFile << "  ]\n";
+	outFile << "}\n";
+
+	return outFile.good();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <optional>
+
+#include "arena.h"
+
+// Per-archetype totals of the bot activity counters (Arena::getBotActivity)
+struct ArchetypeActivity {
+	int bots = 0;
+	BotActivity activity;
+};
+
+using ActivityTotals = std::array<ArchetypeActivity, static_cast<size_t>(BotArchetype::Count)>;
+
+ActivityTotals summarizeActivity(const std::vector<BotActivityRecord>& records);
+
+// Locks taken per move, skill, attack or pickup - nullopt without a useful action, or without locks
+// charged to bots, as in lockstep rounds
+std::optional<double> getLocksPerUsefulAction(const BotActivity& activity);
+
+// Table of the archetype totals on the console
+void printActivitySummary(const std::vector<BotActivityRecord>& records);
+
+// JSON report: the archetype totals, the game totals and every bot - false when the file cannot be written
+bool writeActivityReport(const std::vector<BotActivityRecord>& records, const std::string& filename);
@@ -1,94 +1,119 @@
 #include "arena.h"
 
-Arena::Arena(int width, int height, int numBots, int numItems) 
-	: width(width), height(height)
+// Live totals for the metrics exporter - the bot activity counters only add up once the bots leave
+struct ArenaMetrics {
+	Counter turns = getMetrics().counter("arena_bot_turns_total", "Bot turns played");
+	Counter moves = getMetrics().counter("arena_moves_total", "Moves committed");
+	std::array<Counter, static_cast<size_t>(MoveFailure::Count)> failedMoves = [] {
+		std::array<Counter, static_cast<size_t>(MoveFailure::Count)> counters;
+		for (size_t i = 0; i < counters.size(); i++)
+			counters[i] = getMetrics().counter("arena_failed_moves_total", "Moves given up", std::format("reason=\"{}\"", moveFailureNames[i]));
+		return counters;
+	}();
+	Counter skills = getMetrics().counter("arena_skills_total", "Heals and power-ups used");
+	Counter attacks = getMetrics().counter("arena_attacks_total", "Attacks made, an area attack counting once");
+	Counter emptyBattleChecks = getMetrics().counter("arena_empty_battle_checks_total", "Battle turns without a target in range");
+	Counter pickups = getMetrics().counter("arena_pickups_total", "Items collected");
+	Counter messages = getMetrics().counter("arena_mailbox_messages_total", "Mailbox messages delivered");
+	Counter snapshots = getMetrics().counter("arena_snapshots_published_total", "Snapshots published");
+	Histogram turnTime = getMetrics().histogram("arena_bot_turn_seconds", "Time one bot turn takes, threaded and scheduled", latencyBuckets);
+	Histogram roundTime = getMetrics().histogram("arena_round_seconds", "Time one lockstep round takes", latencyBuckets);
+
+	void failedMove(MoveFailure reason) const { failedMoves[static_cast<size_t>(reason)].increment(); }
+};
+
+static const ArenaMetrics arenaMetrics;
+
+Arena::Arena(int width, int height, int numBots, int numItems)
+	: Arena(width, height, numBots, numItems, evenArchetypeMix, std::random_device{}())
 {
+}
+
+Arena::Arena(int width, int height, int numBots, int numItems, const ArchetypeMix& archetypeMix, uint32_t seed)
+	: Arena(width, height, numBots, numItems, archetypeMix, seed, { 0, height, 0 })
+{
+}
+
+Arena::Arena(int width, int height, int numBots, int numItems, const ArchetypeMix& archetypeMix, uint32_t seed, const ArenaSlab& slab)
+	: width(width), height(height), slab(slab), bots(width, height), botPool(reclamation), 
+	itemTiles(static_cast<size_t>(width) * height), itemPool(reclamation),
+	archetypeMix(archetypeMix), rng(seed)
+{
+	itemFields.reserve(static_cast<size_t>(ItemType::Count));
+	for (size_t type = 0; type < static_cast<size_t>(ItemType::Count); type++)
+		itemFields.emplace_back(width, height);
+
 	initializeBots(numBots);
 	initializeItems(numItems);
+	publishSnapshot();
 
-	int itemCount = static_cast<int>(items.size());
-	std::cout << std::format("Total items in arena: {}", itemCount) << std::endl;
+	printLine("Total items in arena: {}", itemPool.getLiveCount());
 
-	int botCount = static_cast<int>(bots.size());
-	std::cout << std::format("Total bots in arena: {}", botCount) << std::endl;
+	int botCount = bots.getCount();
+	printLine("Total bots in arena: {}", botCount);
 }
 
-// Initialize bots in the arena
+// Initialize bots in the arena - a slab draws every bot, so it sees the same random sequence, but only keeps its own
 void Arena::initializeBots(const int numOfBots)
 {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
 	std::set<std::pair<int, int>> botPositions;
+	std::vector<Bot*> createdBots;
 
 	// Initialize uniform distributions
 	std::uniform_int_distribution<> distribWidth(0, width - 1);
 	std::uniform_int_distribution<> distribHeight(0, height - 1);
-	std::uniform_int_distribution<> botArchtypeDistrib(0, static_cast<int>(BotArchetype::Count) - 1);
+	std::discrete_distribution<> botArchtypeDistrib(archetypeMix.begin(), archetypeMix.end());
 
 	while (botPositions.size() < numOfBots) {
-		int x = distribWidth(gen);
-		int y = distribHeight(gen);
+		int x = distribWidth(rng);
+		int y = distribHeight(rng);
 
 		auto result = botPositions.insert({ x, y });
 
 		if (result.second) {
-			// Randomly select a bot archetype
-			BotArchetype archetype = static_cast<BotArchetype>(botArchtypeDistrib(gen));
-
-			std::string name = "Bot_" + std::to_string(botPositions.size() - 1);
-
-			switch (archetype) {
-				case BotArchetype::Warrior:
-					name += "_Warrior";
-					this->bots.insert({ { x, y }, new WarriorBot(name, x, y) });
-					break;
-				case BotArchetype::Mage:
-					name += "_Mage";
-					this->bots.insert({ { x, y }, new MageBot(name, x, y) });
-					break;
-				case BotArchetype::Tank:
-					name += "_Tank";
-					this->bots.insert({ { x, y }, new TankBot(name, x, y) });
-					break;
-				case BotArchetype::Archer:
-					name += "_Archer";
-					this->bots.insert({ { x, y }, new ArcherBot(name, x, y) });
-					break;
-				default:
-					printColoredText("BOT INITIALIZATION FAILED", Color::Red);
-					std::cout << "Invalid bot archetype!" << std::endl;
-					return;
+			// Randomly select a bot archetype, weighted by the archetype mix
+			BotArchetype archetype = static_cast<BotArchetype>(botArchtypeDistrib(rng));
+			if (!slab.ownsRow(y))
+				continue;
+
+			Bot* newBot = createBot(archetype, static_cast<int>(botPositions.size()) - 1, x, y);
+			if (newBot == nullptr) {
+				printColoredText("BOT INITIALIZATION FAILED", Color::Red);
+				std::cout << "Invalid bot archetype!" << std::endl;
+				return;
 			}
 
-			// Store in botList for easy access
-			this->botList.push_back(this->bots[{ x, y }]); 
+			this->bots.place(newBot, x, y);
 
-			// Set the index of the bot
-			this->bots[{ x, y }]->setIndex(static_cast<int>(botPositions.size()) - 1);
+			// Store in the pool for easy access - in a whole arena the handle index matches the bot id
+			newBot->setHandle(botPool.insert(newBot));
+			createdBots.push_back(newBot); 
 		}
 	}
 
+	// Group bots by archetype once - archetypes never change, so batched evaluation only needs to drop dead bots
+	botsByArchetype = createdBots;
+	std::stable_sort(botsByArchetype.begin(), botsByArchetype.end(), [](const Bot* a, const Bot* b) {
+		return a->getArchetypeType() < b->getArchetypeType();
+	});
+
 	// Output bots to verify
 	printColoredText("Bots Initialized:", Color::Yellow);
-	for (const auto& botPair : bots) {
-		std::cout << format("{} at position x: {}, y: {} with {} health, attack power {}, defense power {}", 
-			botPair.second->getName(), 
-			botPair.second->getX(), 
-			botPair.second->getY(), 
-			botPair.second->getHealth(), 
-			botPair.second->getAttackPower(),
-			botPair.second->getDefensePower()
-		) << std::endl;
+	for (const Bot* bot : createdBots) {
+		printLine("{} at position x: {}, y: {} with {} health, attack power {}, defense power {}", 
+			bot->getName(), 
+			bot->getX(), 
+			bot->getY(), 
+			bot->getHealth(), 
+			bot->getAttackPower(),
+			bot->getDefensePower()
+		);
 	}
 }
 
-// Initialize items in the arena
+// Initialize items in the arena - a slab keeps the ones in its rows and halo
 void Arena::initializeItems(const int numOfItems)
 {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
 	std::set<std::pair<int, int>> itemPositions;
 
 	// Initialize uniform distributions
@@ -97,130 +122,224 @@ void Arena::initializeItems(const int numOfItems)
 	std::uniform_int_distribution<> distribItemType(0, static_cast<int>(ItemType::Count) - 1);
 
 	while (itemPositions.size() < numOfItems) {
-		int x = distribWidth(gen);
-		int y = distribHeight(gen);
-		ItemType type = static_cast<ItemType>(distribItemType(gen));
+		int x = distribWidth(rng);
+		int y = distribHeight(rng);
+		ItemType type = static_cast<ItemType>(distribItemType(rng));
 
 		// Try to insert the pair  only unique pairs are kept
 		auto result = itemPositions.insert({ x, y });
 
-		if (result.second) {
-			// Add to internal map
+		if (result.second && slab.seesRow(y)) {
+			// Add to internal grid
 			// Create a new item based on the type
-			switch (type) {
-				case ItemType::Health:
-					this->items.insert({ { x, y }, new HealthItem(x, y) });
-					break;
-				case ItemType::Weapon:
-					this->items.insert({ { x, y }, new WeaponItem(x, y) });
-					break;
-			}
+			if (Item* item = createItem(x, y, type))
+				addItem(item);
 		}
 	}
 
 	// Output positions to verify
 	printColoredText("Items Initialized:", Color::Yellow);
-	for (const auto& itemPair : this->items) {
-		std::cout << std::format("Item: type {} at position x: {}, y: {}", 
-			itemPair.second->getDescription(), itemPair.second->getX(), itemPair.second->getY()) << std::endl;
+	for (const Item* item : itemPool.live()) {
+		if (item != nullptr)
+			printLine("Item: type {} at position x: {}, y: {}", 
+				item->getDescription(), item->getX(), item->getY());
 	}
 }
 
-std::pair<int, int> Arena::getNearestEnemy(int botIndex) const
+// Store a new item on its tile - caller holds arenaMutex
+void Arena::addItem(Item* item)
 {
-	auto& bot = botList[botIndex];
+	item->setHandle(itemPool.insert(item));
+	itemTiles[static_cast<size_t>(item->getY()) * width + item->getX()].store(item, std::memory_order_release);
+	itemFields[static_cast<size_t>(item->getType())].addSource(item->getX(), item->getY());
+}
 
-	int closestDist = INT_MAX;
-	int targetX = bot->getX();
-	int targetY = bot->getY();
+// Take a collected item off the board - caller holds arenaMutex
+void Arena::removeItem(Item* item)
+{
+	itemTiles[static_cast<size_t>(item->getY()) * width + item->getX()].store(nullptr, std::memory_order_release);
+	itemPool.remove(item->getHandle());
+	itemFields[static_cast<size_t>(item->getType())].removeSource(item->getX(), item->getY());
+	reclamation.retire(item); // Lock-free readers may still be looking at it
 
-	for (const auto& otherBot : bots)
-	{
-		if (otherBot.second == bot)
-			continue;  // skip self
+	itemPool.compactIfFragmented();
+}
 
-		int dist = std::abs(otherBot.second->getX() - bot->getX()) + std::abs(otherBot.second->getY() - bot->getY());
-		if (dist < closestDist)
-		{
-			closestDist = dist;
-			targetX = otherBot.second->getX();
-			targetY = otherBot.second->getY();
-		}
+bool Arena::setFactions(const std::vector<int>& sizes)
+{
+	TimedLockGuard guard(arenaMutex);
+
+	bool valid = !sizes.empty();
+	int total = 0;
+	for (int size : sizes) {
+		valid = valid && size > 0;
+		total += size;
 	}
 
-	return { targetX, targetY };
+	if (!valid || total != bots.getCount()) {
+		printColoredText("FACTIONS FAILED", Color::Red);
+		printLine("Faction sizes must be positive and add up to {} bots", bots.getCount());
+		return false;
+	}
+
+	assignFactions(sizes);
+
+	printColoredText("FACTIONS", Color::Yellow);
+	for (size_t i = 0; i < sizes.size(); i++)
+		printLine("Faction {}: {} bots", i, bots.getFactionSize(static_cast<int>(i)));
+
+	return true;
+}
+
+// Ids are in creation order, and creation placed the bots randomly
+void Arena::assignFactions(const std::vector<int>& sizes)
+{
+	std::vector<int> firstIds(sizes.size() + 1, 0);
+	for (size_t i = 0; i < sizes.size(); i++)
+		firstIds[i + 1] = firstIds[i] + sizes[i];
+
+	for (Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			bot->setFaction(static_cast<int>(std::upper_bound(firstIds.begin(), firstIds.end(), bot->getId()) - firstIds.begin()) - 1);
+	}
+
+	bots.setFactionCount(static_cast<int>(sizes.size()));
+}
+
+// Handles of every bot in the arena, e.g. to start a thread per bot
+std::vector<BotHandle> Arena::getBotHandles() const
+{
+	EpochGuard epoch(reclamation);
+
+	std::vector<BotHandle> handles;
+	for (const Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			handles.push_back(bot->getHandle());
+	}
+
+	return handles;
+}
+
+std::pair<int, int> Arena::getNearestEnemy(BotHandle handle) const
+{
+	EpochGuard epoch(reclamation);
+
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return { -1, -1 }; // Stale handle - the bot has left the arena
+
+	// Rows are searched outwards from the bot, so the cost depends on how far the enemy is, not on how many bots there are
+	auto [x, y] = bot->getPosition();
+	std::optional<std::pair<int, int>> nearest = bots.findNearestEnemy(x, y, bot->getFaction(), getVisionRadius(*bot));
+	if (nearest)
+		return *nearest;
+
+	return { x, y }; // No enemy left
 }
 
-std::pair<int, int> Arena::getWeakestEnemy(int botIndex) const
+std::pair<int, int> Arena::getWeakestEnemy(BotHandle handle) const
 {
-	auto& bot = botList[botIndex];
+	EpochGuard epoch(reclamation);
+
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return { -1, -1 }; // Stale handle - the bot has left the arena
 
 	int lowestHealth = INT_MAX;
 	int targetX = bot->getX();
 	int targetY = bot->getY();
 
-	for (const auto& otherBot : bots)
-	{
-		if (otherBot.second == bot)
-			continue;  // skip self
+	// Allies and tiles out of sight are masked out of the bitboard words, so they are never visited
+	int radius = getVisionRadius(*bot);
+	auto [x, y] = bot->getPosition();
+	bots.forEachEnemyInRect(bot->getFaction(), x - radius, y - radius, x + radius, y + radius, [&](const Bot* otherBot) {
+		if (otherBot == bot)
+			return; // skip self
 
-		int health = otherBot.second->getHealth();
+		int health = otherBot->getHealth();
 		if (health < lowestHealth)
 		{
 			lowestHealth = health;
-			targetX = otherBot.second->getX();
-			targetY = otherBot.second->getY();
+			targetX = otherBot->getX();
+			targetY = otherBot->getY();
 		}
-	}
+	});
 
 	return { targetX, targetY };
 }
 
-std::pair<int, int> Arena::getNearestItem(int botIndex, ItemType type) const
+std::pair<int, int> Arena::getNearestItem(BotHandle handle, ItemType type) const
 {
-	auto& bot = botList[botIndex];
+	EpochGuard epoch(reclamation);
 
-	int closestDist = INT_MAX;
-	int targetX = bot->getX();
-	int targetY = bot->getY();
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return { -1, -1 }; // Stale handle - the bot has left the arena
 
-	for (const auto& item : items)
-	{
-		if (item.second->getType() == type)
-		{
-			int dist = std::abs(item.second->getX() - bot->getX()) + std::abs(item.second->getY() - bot->getY());
-			if (dist < closestDist)
-			{
-				closestDist = dist;
-				targetX = item.second->getX();
-				targetY = item.second->getY();
-			}
+	// The distance field already knows the nearest item of each type for every tile. It counts Chebyshev
+	// steps, so when the nearest item is beyond the vision radius no item is in sight.
+	auto [x, y] = bot->getPosition();
+	const DistanceField& field = itemFields[static_cast<size_t>(type)];
+	std::optional<std::pair<int, int>> nearest = field.getNearestSource(x, y);
+	if (nearest && field.getDistance(x, y) <= getVisionRadius(*bot))
+		return *nearest;
+
+	// Return -1, -1 to indicate no item found
+	return { -1, -1 };
+}
+
+std::optional<std::pair<int, int>> Arena::getItemFieldMove(const Bot& bot, ItemType type) const
+{
+	const DistanceField& field = itemFields[static_cast<size_t>(type)];
+
+	int x = bot.getX();
+	int y = bot.getY();
+	uint16_t distance = field.getDistance(x, y);
+	if (distance == DistanceField::unreachable)
+		return std::nullopt;
+
+	// Every tile but a source has a neighbour one step closer - take the first free one
+	for (int step = 0; step < bot.getSpeed() && distance > 0; step++) {
+		bool moved = false;
+
+		for (const auto& [dx, dy] : adjacentDirections) {
+			int nx = x + dx;
+			int ny = y + dy;
+			if (!bots.isInside(nx, ny) || bots.isOccupied(nx, ny) || field.getDistance(nx, ny) >= distance)
+				continue;
+
+			x = nx;
+			y = ny;
+			distance = field.getDistance(nx, ny);
+			moved = true;
+			break;
 		}
-	}
 
-	// If an item was found return its position
-	if (closestDist < INT_MAX)
-	{
-		return { targetX, targetY };
+		if (!moved)
+			break;
 	}
 
-	// Return -1, -1 to indicate no item found
-	return { -1, -1 };
+	// Walled in by other bots - leave it to the path search
+	if (x == bot.getX() && y == bot.getY() && distance > 0)
+		return std::nullopt;
+
+	return std::make_pair(x - bot.getX(), y - bot.getY());
 }
 
 // Function each thread will run
-void Arena::runBot(int botIndex)
+void Arena::runBot(BotHandle handle)
 {
-	// Collect the bot from the list - each thread will have its own bot index
-	// Bots are NOT spawned, meaning this is a thread-safe operation
-	auto& bot = botList[botIndex];
+	// Collect the bot from the pool - each thread will have its own bot handle
+	// A bot is only removed by its own thread, so the pointer stays valid until the end
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return;
 
 	// Random generator for bot movement
 	std::random_device rd;
 	std::mt19937 gen(rd());
 
 	std::uniform_int_distribution<> sleepDistrib(100, 1000); // Random sleep time in milliseconds
-	std::uniform_int_distribution<> actionDistrib(0, 1); // Random action (0: move, 1: battle)
 
 	// Thread running time measurement
 	auto start = std::chrono::high_resolution_clock::now();
@@ -228,86 +347,303 @@ void Arena::runBot(int botIndex)
 	// Loop until the game is over
 	while (!isGameOver()) 
 	{
-		// Check if the bot is dead
-		if (bot->isAlive == false)
+		if (!playBotTurn(bot, gen))
 			break;
 
-		checkAndCollectItem(botIndex);
+		// Random sleep to simulate time between moves
+		std::this_thread::sleep_for(std::chrono::milliseconds(sleepDistrib(gen)));
+	}
 
-		// Check if the bot is dead
-		if (bot->isAlive == false)
-			break;
+	TimedLockGuard guard(arenaMutex);
+
+	auto end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsed = end - start;
+
+	// Store the execution time for this thread
+	threadExecutionTimeMap[std::this_thread::get_id()] = elapsed;
+
+	removeBot(bot);
+	botPool.compactIfFragmented();
+}
+
+// Counts a bot turn and charges the locks its thread took meanwhile to the bot
+class TurnRecorder {
+private:
+	BotActivity& activity;
+	LockUsage start;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+public:
+	explicit TurnRecorder(BotActivity& activity) : activity(activity), start(getThreadLockUsage()) {
+		activity.beginTurn();
+		arenaMetrics.turns.increment();
+	}
+
+	~TurnRecorder() {
+		const LockUsage& now = getThreadLockUsage();
+		activity.endTurn(now.acquisitions - start.acquisitions, (now.waitTime - start.waitTime).count());
+		arenaMetrics.turnTime.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+	}
+};
+
+// One turn of a bot: collect an item, then randomly move or battle - false once the bot is dead
+bool Arena::playBotTurn(Bot* bot, std::mt19937& gen)
+{
+	BotHandle handle = bot->getHandle();
+	std::uniform_int_distribution<> actionDistrib(0, 1); // Random action (0: move, 1: battle)
+
+	// Check if the bot is dead
+	if (!bot->isAlive())
+		return false;
+
+	TurnRecorder recorder(bot->getActivity());
+
+	// Attacks and expiries sent since the last turn - the only writes to the bot's stats in mailbox mode
+	if (usesMailboxes()) {
+		deliverMessages(bot);
+		if (!bot->isAlive())
+			return false;
+	}
+
+	advanceBuffClock(getWallBuffTick());
+	checkAndCollectItem(handle);
+
+	// Check if the bot is dead
+	if (!bot->isAlive())
+		return false;
+
+	// Randomly decide to move or battle
+	int action = actionDistrib(gen);
+	if (action == 0)
+	{
+		moveBot(handle);
+	}
+	else
+	{
+		// The target is picked under the lock, the attack itself only touches the bots it hits.
+		// The epoch guard keeps the targets readable even if their own threads remove them meanwhile.
+		EpochGuard epoch(reclamation);
+
+		thread_local std::vector<Bot*> targets;
+		Bot* targetBot = nullptr;
 
-		// Randomly decide to move or battle
-		int action = actionDistrib(gen);
-		if (action == 0)
-		{
-			moveBot(botIndex);
-		}
-		else
 		{
 			// Check for potential battles
 			TimedLockGuard guard(arenaMutex);
 
 			// Check if the bot is dead before proceeding
-			if (bot->isAlive == false)
-				break;
+			if (!bot->isAlive())
+				return false;
 
-			auto battlePositions = checkBattles(botIndex);
-			if (!battlePositions.empty()) 
+			targets.clear();
+			findTargets(*bot, targets);
+			if (!targets.empty()) 
 			{
-				// Randomly select a target bot from the battle positions
-				std::uniform_int_distribution<> targetDistrib(0, static_cast<int>(battlePositions.size()) - 1);
-
-				int targetIndex = targetDistrib(gen);
-				auto targetPos = battlePositions[targetIndex];
-				auto targetBotIt = bots.find(targetPos);
-
-				if (targetBotIt != bots.end()) {
-					battle(botIndex, targetBotIt->second->getIdx());
-				}
-				else {
-					printColoredText("BATTLE FAILED", Color::Red);
-					std::cout << "Target bot not found!" << std::endl;
-				}
-			}
-			else
-			{
-				printColoredText("NO BATTLE", Color::Yellow);
-				std::cout << std::format("{} found no potential battles.", bot->getName()) << std::endl;
+				// Randomly select a target bot within range
+				std::uniform_int_distribution<> targetDistrib(0, static_cast<int>(targets.size()) - 1);
+				targetBot = targets[targetDistrib(gen)];
 			}
 		}
 
-		// Random sleep to simulate time between moves
-		std::this_thread::sleep_for(std::chrono::milliseconds(sleepDistrib(gen)));
+		if (targetBot == nullptr)
+		{
+			bot->getActivity().emptyBattleChecks++;
+			arenaMetrics.emptyBattleChecks.increment();
+
+			printColoredText("NO BATTLE", Color::Yellow);
+			printLine("{} found no potential battles.", bot->getName());
+		}
+		else {
+			printColoredText("BATTLE CHECK", Color::Yellow);
+			printLine("{} has {} bots in range", bot->getName(), targets.size());
+
+			// Health changes are picked up by the next snapshot published under the lock
+			attack(bot, targetBot);
+			bot->getActivity().attacks++;
+			arenaMetrics.attacks.increment();
+		}
 	}
 
-	TimedLockGuard guard(arenaMutex);
+	return true;
+}
 
-	auto end = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed = end - start;
+// Scheduled simulation: bot turns and item spawns are timers on a few scheduler threads. Each turn
+// schedules the bot's next one after the same random pause runBot sleeps for.
+void Arena::runScheduled(int numThreads, int itemSpawnMillis)
+{
+	std::uniform_int_distribution<> sleepDistrib(100, 1000); // Random pause between turns in milliseconds
+	std::uniform_int_distribution<> distribWidth(0, width - 1);
+	std::uniform_int_distribution<> distribHeight(0, height - 1);
+	std::uniform_int_distribution<> distribItemType(0, static_cast<int>(ItemType::Count) - 1);
 
-	// Store the execution time for this thread
-	threadExecutionTimeMap[std::this_thread::get_id()] = elapsed;
+	simulationMode = SimulationMode::Scheduled;
+	std::atomic<bool> finished{ getNumOfBots() <= 1 };
+	Scheduler scheduler(numThreads);
+
+	// A bot is only removed by its own turn, and turns of one bot never overlap
+	std::function<void(BotHandle)> turn = [&](BotHandle handle) {
+		thread_local std::mt19937 gen(std::random_device{}());
 
+		Bot* bot = botPool.get(handle);
+		if (bot == nullptr)
+			return;
+
+		if (!isGameOver() && playBotTurn(bot, gen)) {
+			std::uniform_int_distribution<> pauseDistrib(100, 1000);
+			scheduler.scheduleAfter(std::chrono::milliseconds(pauseDistrib(gen)), [&turn, handle] { turn(handle); });
+			return;
+		}
+
+		{
+			TimedLockGuard guard(arenaMutex);
+			removeBot(bot);
+			botPool.compactIfFragmented();
+		}
+
+		if (getNumOfBots() <= 1) {
+			finished = true;
+			finished.notify_all();
+		}
+	};
+
+	// Only the spawn timer uses the arena generator, and it never overlaps itself
+	std::function<void()> spawn = [&] {
+		spawnItem(distribWidth(rng), distribHeight(rng), static_cast<ItemType>(distribItemType(rng)));
+		scheduler.scheduleAfter(std::chrono::milliseconds(itemSpawnMillis), spawn);
+	};
+
+	for (BotHandle handle : getBotHandles())
+		scheduler.scheduleAfter(std::chrono::milliseconds(sleepDistrib(rng)), [&turn, handle] { turn(handle); });
+	scheduler.scheduleAfter(std::chrono::milliseconds(itemSpawnMillis), spawn);
+
+	finished.wait(false);
+	scheduler.stop();
+
+	// The winner leaves once the game is over, whether or not its turn came
+	TimedLockGuard guard(arenaMutex);
+	for (Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			removeBot(bot);
+	}
+}
+
+// Remove a bot that left the game - caller holds arenaMutex
+void Arena::removeBot(Bot* bot)
+{
 	printColoredText("BOT LEFT", Color::Yellow);
-	std::cout << std::format("{} left. Bot had {} health. Bot {}", 
+	printLine("{} left. Bot had {} health. Bot {}", 
 		bot->getName(), 
 		bot->getHealth(), 
 		bot->getHealth() <= 0 ? "LOST" : "WON"
-	) << std::endl;
+	);
+
+	departedActivity.push_back({ bot->getId(), bot->getArchetypeType(), bot->getFaction(), bot->isAlive(), bot->getActivity() });
 
 	// Remove the bot from the arena
-	bots.erase({ bot->getX(), bot->getY() }); // Remove from the map
-	botList[botIndex] = nullptr; // Remove from the list
-	delete bot; // Free memory
+	bots.remove(bot->getX(), bot->getY()); // Remove from the grid
+	botPool.remove(bot->getHandle()); // Remove from the pool - outstanding handles go stale
+	removedBots.push_back(bot); // Dropped from botsByArchetype in one pass by the next decideAllMoves
+	reclamation.retire(bot); // Freed once no lock-free reader can still hold it
+
+	recordMutation();
+	publishSnapshotIfDue();
 
 	displayArena();	
 }
 
+std::vector<BotActivityRecord> Arena::getBotActivity() const
+{
+	std::vector<BotActivityRecord> records = departedActivity;
+	for (const Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			records.push_back({ bot->getId(), bot->getArchetypeType(), bot->getFaction(), bot->isAlive(), bot->getActivity() });
+	}
+
+	std::sort(records.begin(), records.end(), [](const BotActivityRecord& a, const BotActivityRecord& b) { return a.id < b.id; });
+	return records;
+}
+
+// Caller holds arenaMutex
+void Arena::adoptBot(Bot* bot)
+{
+	// A new bot may have the address of one that left and is still listed, maybe under another archetype
+	if (std::erase(removedBots, bot) > 0)
+		std::erase(botsByArchetype, bot);
+
+	bots.place(bot, bot->getX(), bot->getY());
+	bot->setHandle(botPool.insert(bot));
+
+	auto byArchetype = [](const Bot* a, const Bot* b) { return a->getArchetypeType() < b->getArchetypeType(); };
+	botsByArchetype.insert(std::upper_bound(botsByArchetype.begin(), botsByArchetype.end(), bot, byArchetype), bot);
+}
+
+// Caller holds arenaMutex
+void Arena::releaseBot(Bot* bot)
+{
+	bots.remove(bot->getX(), bot->getY());
+	botPool.remove(bot->getHandle());
+	removedBots.push_back(bot);
+	reclamation.retire(bot);
+}
+
+// Publish an immutable copy of the current state - caller holds arenaMutex
+void Arena::publishSnapshot()
+{
+	pendingMutations.store(0, std::memory_order_relaxed);
+
+	// A reclaimed snapshot keeps its capacity - refilling it allocates nothing once the arena settles
+	ArenaSnapshot* snapshot = snapshotPool.acquire();
+	snapshot->version = ++snapshotVersion;
+	arenaMetrics.snapshots.increment();
+	snapshot->width = width;
+	snapshot->height = height;
+	snapshot->tiles.assign(static_cast<size_t>(width) * height, TileSnapshot{});
+	snapshot->bots.clear();
+	snapshot->items.clear();
+
+	// A pooled snapshot that is short grows with headroom, so the next few counts fit without regrowing
+	if (snapshot->bots.capacity() < botPool.getLiveCount())
+		snapshot->bots.reserve(2 * botPool.getLiveCount());
+	for (const Bot* bot : botPool.live()) {
+		if (bot == nullptr)
+			continue;
+
+		auto [x, y] = bot->getPosition();
+		snapshot->tiles[static_cast<size_t>(y) * width + x].bot = static_cast<int32_t>(snapshot->bots.size());
+		snapshot->bots.push_back({ bot->getIdx(), bot->getArchetypeType(), x, y, bot->getCombatStats(), bot->getFaction() });
+	}
+
+	if (snapshot->items.capacity() < itemPool.getLiveCount())
+		snapshot->items.reserve(2 * itemPool.getLiveCount());
+	for (const Item* item : itemPool.live()) {
+		if (item == nullptr)
+			continue;
+
+		snapshot->tiles[static_cast<size_t>(item->getY()) * width + item->getX()].item = static_cast<int32_t>(snapshot->items.size());
+		snapshot->items.push_back({ item->getX(), item->getY(), item->getType() });
+	}
+
+	// Readers holding the previous snapshot keep it until they leave their epoch
+	const ArenaSnapshot* previous = currentSnapshot.exchange(snapshot, std::memory_order_acq_rel);
+	if (previous != nullptr)
+		reclamation.retire(const_cast<ArenaSnapshot*>(previous), &SnapshotPool::recycle);
+}
+
+void Arena::publishSnapshotIfDue()
+{
+	if (snapshotInterval > 0 && pendingMutations.load(std::memory_order_relaxed) >= snapshotInterval)
+		publishSnapshot();
+}
+
 // Display the current state of the arena
 void Arena::displayArena()
 {
+	if (!isLoggingEnabled())
+		return;
+
+	// The board is drawn from the latest snapshot - no lock, and the simulation is never held up
+	SnapshotView snapshot = getSnapshot();
+
 	printColoredText("ARENA STATE:", Color::Cyan);
 
 	int cellWidth = 6; // Adjust as needed for better readability
@@ -324,26 +660,29 @@ void Arena::displayArena()
 		std::cout << std::setw(cellWidth) << y; // row index
 
 		for (int x = 0; x < width; ++x) {
-			auto botIt = bots.find({ x, y });
-			auto itemIt = items.find({ x, y });
+			const TileSnapshot& tile = snapshot->tile(x, y);
+			const BotSnapshot* cellBot = tile.bot >= 0 ? &snapshot->bots[tile.bot] : nullptr;
+			const ItemSnapshot* cellItem = tile.item >= 0 ? &snapshot->items[tile.item] : nullptr;
 
-			std::string cell;
+			// Cell text is formatted into a stack buffer - no string is built per cell
+			char buffer[32];
+			char* end = buffer;
 
-			if (botIt != bots.end() && itemIt != items.end()) {
+			if (cellBot != nullptr && cellItem != nullptr) {
 				// Both bot and item
-				cell = "B" + std::to_string(botIt->second->getIdx()) + "/" + itemIt->second->printType();
+				end = std::format_to_n(buffer, sizeof(buffer), "B{}/{}", cellBot->index, itemSymbols[static_cast<size_t>(cellItem->type)]).out;
 			}
-			else if (botIt != bots.end()) {
-				cell = "B" + std::to_string(botIt->second->getIdx());
+			else if (cellBot != nullptr) {
+				end = std::format_to_n(buffer, sizeof(buffer), "B{}", cellBot->index).out;
 			}
-			else if (itemIt != items.end()) {
-				cell = itemIt->second->printType();
+			else if (cellItem != nullptr) {
+				end = std::format_to_n(buffer, sizeof(buffer), "{}", itemSymbols[static_cast<size_t>(cellItem->type)]).out;
 			}
 			else {
-				cell = ".";
+				*end++ = '.';
 			}
 
-			std::cout << std::setw(cellWidth) << cell;
+			std::cout << std::setw(cellWidth) << std::string_view(buffer, end);
 		}
 		std::cout << "\n";
 	}
@@ -354,30 +693,54 @@ bool Arena::isGameOver()
 {
 	TimedLockGuard guard(arenaMutex);
 
-	if (bots.size() == 1)
+	if (bots.getCount() == 1)
+		return true;
+
+	// A team game ends once a single faction is left
+	if (bots.getFactionCount() > 0 && bots.getLiveFactionCount() <= 1)
 		return true;
 
 	return false;
 }
 
 // Thread-safe moving of bots
-void Arena::moveBot(int botIndex)
+void Arena::moveBot(BotHandle handle)
 {
+	if (moveMode == MoveMode::Optimistic) {
+		moveBotOptimistic(handle);
+		return;
+	}
+
 	TimedLockGuard guard(arenaMutex);
 
-	auto& bot = botList[botIndex];
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return; // Stale handle - the bot has left the arena
 
 	// Check if the bot is alive
 	if (bot->getHealth() == 0)
 	{
 		printColoredText("MOVE FAILED", Color::Red);
-		std::cout << std::format("{} cannot move - bot is dead!", bot->getName()) << std::endl;
+		printLine("{} cannot move - bot is dead!", bot->getName());
 		return;
 	}
 
+	moveAttempts.fetch_add(1, std::memory_order_relaxed);
+
 	// Get the move direction from the bot based on the strategy of its archetype
-	std::pair<int, int> moveDirection = bot->decideMove(*this); 
+	MoveIntent intent = dispatchMode == DispatchMode::Static
+		? decideMoveStatic(*bot, *this)
+		: bot->decideMove(*this);
+
+	if (intent.action != IntentAction::Move)
+		useSkill(bot, intent);
+	else
+		commitMove(bot, intent.direction);
+}
 
+// Move a bot by the decided direction - caller holds arenaMutex
+void Arena::commitMove(Bot* bot, std::pair<int, int> moveDirection)
+{
 	// New positions with boundary check - allows for wrapping around
 	int newX = std::clamp(bot->getX() + moveDirection.first, 0, width - 1);
 	int newY = std::clamp(bot->getY() + moveDirection.second, 0, height - 1);
@@ -387,196 +750,1010 @@ void Arena::moveBot(int botIndex)
 	auto oldPos = std::make_pair(bot->getX(), bot->getY());
 
 	if (newPos == oldPos) {
+		bot->getActivity().failedMoves[static_cast<size_t>(MoveFailure::AlreadyThere)]++;
+		arenaMetrics.failedMove(MoveFailure::AlreadyThere);
+
 		printColoredText("MOVE FAILED", Color::Red);
-		std::cout << std::format("{} cannot move to position x: {}, y: {} - already there",
+		printLine("{} cannot move to position x: {}, y: {} - already there",
 			bot->getName(), 
 			newX, 
 			newY
-		) << std::endl;
+		);
 		return;
 	}
 
-	if (bots.find(newPos) != bots.end()) {
+	// Change position in the grid - fails if the tile is taken
+	if (!bots.move(oldPos.first, oldPos.second, newX, newY)) {
+		bot->getActivity().failedMoves[static_cast<size_t>(MoveFailure::Occupied)]++;
+		arenaMetrics.failedMove(MoveFailure::Occupied);
+
 		printColoredText("MOVE FAILED", Color::Red);
-		std::cout << std::format("{} cannot move to position x: {}, y: {} - occupied by another bot",
+		printLine("{} cannot move to position x: {}, y: {} - occupied by another bot",
 			bot->getName(), 
 			newX, 
 			newY
-		) << std::endl;
+		);
 		return;
 	}
 
-	// Change position in the map
 	bot->setPosition(newX, newY);
-	
-	bots.erase(oldPos);
-	bots.insert({ newPos, bot });
+	moveCommits.fetch_add(1, std::memory_order_relaxed);
+	bot->getActivity().moves++;
+	arenaMetrics.moves.increment();
 
 	printColoredText("MOVE", Color::Yellow);
-	std::cout << std::format("{} moved to position x: {}, y: {}", bot->getName(), newX, newY) << std::endl;
+	printLine("{} moved to position x: {}, y: {}", bot->getName(), newX, newY);
+
+	recordMutation();
+	publishSnapshotIfDue();
 
 	displayArena();
 }
 
+// Optimistic moving of bots: the strategy runs without any lock, and the commit only validates that the
+// source and destination tiles are unchanged since they were read - otherwise the move is decided again
+void Arena::moveBotOptimistic(BotHandle handle)
+{
+	// The queries of decideMove nest their guards in this one - they reuse its slot
+	EpochGuard epoch(reclamation);
+
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return; // Stale handle - the bot has left the arena
+
+	// Check if the bot is alive
+	if (!bot->isAlive())
+	{
+		printColoredText("MOVE FAILED", Color::Red);
+		printLine("{} cannot move - bot is dead!", bot->getName());
+		return;
+	}
+
+	moveAttempts.fetch_add(1, std::memory_order_relaxed);
+
+	for (int attempt = 0; attempt <= maxMoveRetries; attempt++) {
+		// Only the bot's own driver moves it, so its position is stable during the attempt
+		auto [x, y] = bot->getPosition();
+		uint32_t fromVersion = bots.getVersion(x, y);
+
+		MoveIntent intent = dispatchMode == DispatchMode::Static
+			? decideMoveStatic(*bot, *this)
+			: bot->decideMove(*this);
+
+		if (intent.action != IntentAction::Move) {
+			useSkill(bot, intent); // A single CAS on the bot's own stats - nothing to validate
+			return;
+		}
+
+		int newX = std::clamp(x + intent.direction.first, 0, width - 1);
+		int newY = std::clamp(y + intent.direction.second, 0, height - 1);
+
+		if (newX == x && newY == y) {
+			bot->getActivity().failedMoves[static_cast<size_t>(MoveFailure::AlreadyThere)]++;
+			arenaMetrics.failedMove(MoveFailure::AlreadyThere);
+
+			printColoredText("MOVE FAILED", Color::Red);
+			printLine("{} cannot move to position x: {}, y: {} - already there", bot->getName(), newX, newY);
+			return;
+		}
+
+		uint32_t toVersion = bots.getVersion(newX, newY);
+		if (bots.isOccupied(newX, newY)) {
+			bot->getActivity().failedMoves[static_cast<size_t>(MoveFailure::Occupied)]++;
+			arenaMetrics.failedMove(MoveFailure::Occupied);
+
+			printColoredText("MOVE FAILED", Color::Red);
+			printLine("{} cannot move to position x: {}, y: {} - occupied by another bot", bot->getName(), newX, newY);
+			return;
+		}
+
+		// Commit - a few atomic operations on the two tiles
+		if (bots.tryMove(x, y, newX, newY, fromVersion, toVersion)) {
+			bot->setPosition(newX, newY);
+			moveCommits.fetch_add(1, std::memory_order_relaxed);
+			bot->getActivity().moves++;
+			arenaMetrics.moves.increment();
+			recordMutation(); // Published by the next snapshot taken under the lock
+
+			printColoredText("MOVE", Color::Yellow);
+			printLine("{} moved to position x: {}, y: {}", bot->getName(), newX, newY);
+
+			displayArena();
+			return;
+		}
+
+		moveRetries.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	moveConflicts.fetch_add(1, std::memory_order_relaxed);
+	bot->getActivity().failedMoves[static_cast<size_t>(MoveFailure::Conflict)]++;
+	arenaMetrics.failedMove(MoveFailure::Conflict);
+
+	printColoredText("MOVE FAILED", Color::Red);
+	printLine("{} gave up moving after {} conflicting attempts", bot->getName(), maxMoveRetries + 1);
+}
+
+// Evaluate the strategy of every live bot without moving it
+void Arena::decideAllMoves(std::vector<MoveIntent>& intents)
+{
+	TimedLockGuard guard(arenaMutex);
+
+	intents.assign(botPool.getSlotCount(), MoveIntent());
+
+	if (!removedBots.empty()) {
+		std::sort(removedBots.begin(), removedBots.end());
+		std::erase_if(botsByArchetype, [this](const Bot* bot) { return std::binary_search(removedBots.begin(), removedBots.end(), bot); });
+		removedBots.clear();
+	}
+
+	// Static dispatch walks the archetype groups, virtual dispatch the live bots
+	decidingBots.clear();
+	if (dispatchMode == DispatchMode::Static) {
+		decidingBots.assign(botsByArchetype.begin(), botsByArchetype.end());
+	}
+	else {
+		for (Bot* bot : botPool.live()) {
+			if (bot != nullptr)
+				decidingBots.push_back(bot);
+		}
+	}
+
+	batchedIntents.resize(decidingBots.size());
+
+	// Strategies only read the arena and write their own intent, so any split of the bots works
+	auto decideRange = [&](size_t begin, size_t end) {
+		if (dispatchMode == DispatchMode::Virtual) {
+			for (size_t i = begin; i < end; i++)
+				batchedIntents[i] = decidingBots[i]->decideMove(*this);
+			return;
+		}
+
+		// One batched loop per archetype group in the range, the branch is taken once per group
+		auto rangeEnd = decidingBots.begin() + end;
+		auto groupStart = decidingBots.begin() + begin;
+		while (groupStart != rangeEnd) {
+			BotArchetype archetype = (*groupStart)->getArchetypeType();
+			auto groupEnd = std::find_if(groupStart, rangeEnd, [archetype](const Bot* bot) {
+				return bot->getArchetypeType() != archetype;
+			});
+
+			auto offset = groupStart - decidingBots.begin();
+			decideMovesBatched(archetype, std::span<Bot* const>(groupStart, groupEnd), *this, batchedIntents.data() + offset);
+
+			groupStart = groupEnd;
+		}
+	};
+
+	if (decidingBots.size() < parallelDecisionThreshold)
+		decideRange(0, decidingBots.size());
+	else
+		getWorkerPool().parallelFor(decidingBots.size(), decideRange);
+
+	for (size_t i = 0; i < decidingBots.size(); i++)
+		intents[decidingBots[i]->getIdx()] = batchedIntents[i];
+}
+
+// Apply intents decided by decideAllMoves - a move fails if an earlier bot took the tile since
+void Arena::applyIntents(const std::vector<MoveIntent>& intents)
+{
+	TimedLockGuard guard(arenaMutex);
+
+	// The live list is in insertion order and compaction reorders it - place the bots by slot index
+	botsByIndex.assign(botPool.getSlotCount(), nullptr);
+	for (Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			botsByIndex[bot->getIdx()] = bot;
+	}
+
+	for (size_t i = 0; i < intents.size() && i < botsByIndex.size(); i++) {
+		Bot* bot = botsByIndex[i];
+		if (bot == nullptr || !bot->isAlive())
+			continue;
+
+		moveAttempts.fetch_add(1, std::memory_order_relaxed);
+
+		const MoveIntent& intent = intents[i];
+		if (intent.action != IntentAction::Move)
+			useSkill(bot, intent);
+		else
+			commitMove(bot, intent.direction);
+	}
+}
+
+// Heal and power-up intents - the bot stays in place
+void Arena::useSkill(Bot* bot, const MoveIntent& intent)
+{
+	switch (intent.action) {
+		case IntentAction::Heal: {
+			StatChange healed = bot->heal(intent.amount);
+
+			printColoredText("HEAL", Color::Green);
+			printLine("MAGE HEALED - {} healed from {} to {} health using MAGIC", 
+				bot->getName(), 
+				healed.previous, 
+				healed.current
+			);
+			break;
+		}
+		case IntentAction::PowerUp: {
+			StatChange powerUp = bot->increaseAttackPower(intent.amount);
+
+			printColoredText("POWER UP", Color::Green);
+			printLine("ARCHER POWER UP - {} increased attack power from {} to {} using SKILLS", 
+				bot->getName(), 
+				powerUp.previous, 
+				powerUp.current
+			);
+			break;
+		}
+		default:
+			return;
+	}
+
+	bot->getActivity().skills++;
+	arenaMetrics.skills.increment();
+	recordMutation();
+}
+
+ThreadPool& Arena::getWorkerPool()
+{
+	if (!workerPool)
+		workerPool = std::make_unique<ThreadPool>(numWorkerThreads, workerCpus);
+
+	return *workerPool;
+}
+
 // Check if the bot is on a tile with an item and collect it
-void Arena::checkAndCollectItem(int botIndex)
+void Arena::checkAndCollectItem(BotHandle handle)
 {
 	TimedLockGuard guard(arenaMutex);
 
-	auto& bot = botList[botIndex];
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return; // Stale handle - the bot has left the arena
 
-	auto botPos = std::make_pair(bot->getX(), bot->getY());
-	auto itemIt = items.find(botPos);
+	auto [x, y] = bot->getPosition();
+	Item* item = getItem(x, y);
 
 	// Check if the bot is on a tile with an item
-	if (itemIt != items.end()) {
+	if (item != nullptr) {
 		// Use the item
-		bool result = itemIt->second->use(bot); 
+		bool result = dispatchMode == DispatchMode::Static
+			? useItemStatic(*item, bot)
+			: item->use(bot);
 
 		if (result)
 		{
+			bot->getActivity().pickups++;
+			arenaMetrics.pickups.increment();
+
+			if (std::optional<BuffType> buff = getItemBuff(item->getType()))
+				scheduleBuffExpiry(bot, *buff);
+
 			printColoredText("ITEM COLLECTED", Color::Yellow);
-			std::cout << std::format("{} collected a {} at position x: {}, y: {}",
+			printLine("{} collected a {} at position x: {}, y: {}",
 				bot->getName(), 
-				itemIt->second->getDescription(), 
+				item->getDescription(), 
 				bot->getX(), 
 				bot->getY()
-			) << std::endl;
+			);
 
 			// Remove the item from the arena
-			delete itemIt->second; // Free memory
-			items.erase(itemIt);
+			removeItem(item);
+
+			printLine("Total items in arena: {}", itemPool.getLiveCount());
 
-			int itemCount = static_cast<int>(items.size());
-			std::cout << std::format("Total items in arena: {}", itemCount) << std::endl;
+			recordMutation();
+			publishSnapshotIfDue();
 
 			displayArena();
 		}
 	}
 }
 
+// The buff wears off after its duration on the buff clock - a bot that left the arena meanwhile is skipped
+void Arena::scheduleBuffExpiry(Bot* bot, BuffType type)
+{
+	// The tick is read under the lock - another turn may be advancing the clock
+	std::lock_guard<std::mutex> lock(buffMutex);
+	scheduleBuffExpiryLocked(bot, type, buffExpiries.getCurrentTick() + getBuffStats(type).duration);
+}
+
+void Arena::scheduleBuffExpiry(Bot* bot, BuffType type, uint64_t dueTick)
+{
+	std::lock_guard<std::mutex> lock(buffMutex);
+	scheduleBuffExpiryLocked(bot, type, dueTick);
+}
+
+void Arena::scheduleBuffExpiryLocked(Bot* bot, BuffType type, uint64_t dueTick)
+{
+	// The type is part of the lambda rather than captured - an arena and a handle fit the inline
+	// storage of std::function, so scheduling an expiry allocates nothing
+	static_assert(static_cast<int>(BuffType::Count) == 3, "Every buff type needs its case below");
+
+	BotHandle handle = bot->getHandle();
+	switch (type) {
+		case BuffType::Shield:
+			buffExpiries.schedule(dueTick, [this, handle] { expireBuff(handle, BuffType::Shield); });
+			break;
+		case BuffType::SpeedBoost:
+			buffExpiries.schedule(dueTick, [this, handle] { expireBuff(handle, BuffType::SpeedBoost); });
+			break;
+		case BuffType::AttackBuff:
+			buffExpiries.schedule(dueTick, [this, handle] { expireBuff(handle, BuffType::AttackBuff); });
+			break;
+		default:
+			break;
+	}
+}
+
+void Arena::expireBuff(BotHandle handle, BuffType type)
+{
+	EpochGuard epoch(reclamation);
+
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return;
+
+	if (usesMailboxes()) {
+		bot->post({ BotMessageKind::BuffExpired, 0, type, -1, std::chrono::steady_clock::now() });
+		return;
+	}
+
+	StatChange change = bot->removeBuff(type);
+	if (change) {
+		printColoredText("BUFF EXPIRED", Color::Blue);
+		printLine("{} {} wore off, {} from {} to {}", 
+			bot->getName(), 
+			getBuffStats(type).name, 
+			getBuffStats(type).stat, 
+			change.previous, 
+			change.current
+		);
+		recordMutation();
+	}
+}
+
+// O(1) per tick plus the expired buffs, whatever the number of bots. Expiries only touch the
+// combat word of their bot, so they run without arenaMutex.
+void Arena::advanceBuffClock(uint64_t tick)
+{
+	std::unique_lock<std::mutex> lock(buffMutex, std::try_to_lock);
+	if (!lock.owns_lock() || tick <= buffExpiries.getCurrentTick())
+		return; // Another turn is already advancing the clock
+
+	buffExpiries.advance(tick, expiredBuffs);
+	for (TimerTask& expire : expiredBuffs)
+		expire();
+	expiredBuffs.clear();
+}
+
 // Spawn an item at a specific position
 void Arena::spawnItem(int x, int y, ItemType type)
 {
 	TimedLockGuard guard(arenaMutex);
 
-	auto itemIt = items.find({ x, y });
-
 	// Check if the position is already occupied by another item - if not, spawn a new item
-	if (itemIt == items.end()) {
+	if (getItem(x, y) == nullptr) {
 		
 		// Create a new item based on the type
-		Item* newItem = nullptr;
-		switch (type) {
-			case ItemType::Health:
-				newItem = new HealthItem(x, y);
-				break;
-			case ItemType::Weapon:
-				newItem = new WeaponItem(x, y);
-				break;
-			default:
-				printColoredText("ITEM SPAWN FAILED", Color::Red);
-				std::cout << "Invalid item type!" << std::endl;
-				return;
+		Item* newItem = createItem(x, y, type);
+		if (newItem == nullptr) {
+			printColoredText("ITEM SPAWN FAILED", Color::Red);
+			std::cout << "Invalid item type!" << std::endl;
+			return;
 		}
 
-		items.insert({ { x, y }, newItem });
+		addItem(newItem);
+		recordMutation();
 
 		printColoredText("ITEM SPAWNED", Color::Blue);
-		std::cout << std::format("Spawned a {} at position x: {}, y: {}",
+		printLine("Spawned a {} at position x: {}, y: {}",
 			newItem->getDescription(), 
 			newItem->getX(), 
 			newItem->getY()
-		) << std::endl;
+		);
 	}
 	else {
 		printColoredText("ITEM SPAWN FAILED", Color::Red);
-		std::cout << std::format("Item already exists at position x: {}, y: {}", x, y) << std::endl;
+		printLine("Item already exists at position x: {}, y: {}", x, y);
 	}
 
-	int itemCount = static_cast<int>(items.size());
-	std::cout << std::format("Total items in arena: {}", itemCount) << std::endl;
+	printLine("Total items in arena: {}", itemPool.getLiveCount());
+
+	publishSnapshotIfDue();
 
 	displayArena();
 }
 
 // Returns all of the adjacent positions of a bot which are occupied by other bots - potential battle positions
-std::vector<std::pair<int, int>> Arena::checkBattles(int botIndex)
+BattlePositions Arena::checkBattles(BotHandle handle)
 {
-	auto& bot = botList[botIndex];
+	// Check all adjacent positions
+	BattlePositions battlePositions;
 
-	auto botPos = std::make_pair(bot->getX(), bot->getY());
+	Bot* bot = botPool.get(handle);
+	if (bot == nullptr)
+		return battlePositions; // Stale handle - the bot has left the arena
 
-	// Check all adjacent positions
-	std::vector<std::pair<int, int>> battlePositions;
-	std::vector<std::pair<int, int>> directions = {
-		{ -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1} 
-	};  //  Up, Down, Left, Right, Diagonal directions
-	
-
-	// Check all four directions
-	for (const auto& dir : directions) {
-		int newX = bot->getX() + dir.first;
-		int newY = bot->getY() + dir.second;
-
-		// Check if the new position is within bounds
-		if (newX >= 0 && newX < width && newY >= 0 && newY < height) {
-			auto pos = std::make_pair(newX, newY);
-
-			// Check if the position is occupied by another bot
-			if (bots.find(pos) != bots.end()) {
-				battlePositions.push_back(pos);
-			}
-		}
+	// Enemy neighbours come from the bitboards in one mask - out of bounds tiles are never set
+	uint32_t neighbours = bots.enemyNeighbourMask(bot->getX(), bot->getY(), bot->getFaction());
+	while (neighbours != 0) {
+		const auto& dir = adjacentDirections[std::countr_zero(neighbours)];
+		neighbours &= neighbours - 1;
+
+		battlePositions.push_back({ bot->getX() + dir.first, bot->getY() + dir.second });
 	}
 
 	// Output battle positions
 	printColoredText("BATTLE CHECK", Color::Yellow);
 	for (const auto& pos : battlePositions) {
-		std::cout << std::format("Potential battle for {} at position x: {}, y: {}", 
+		printLine("Potential battle for {} at position x: {}, y: {}", 
 			bot->getName(), 
 			pos.first, 
 			pos.second
-		) << std::endl;
+		);
 	}
 
 	return battlePositions;
 }
 
 // Perform a battle between two bots
-void Arena::battle(int botIndex, int targetBotIndex)
+void Arena::battle(BotHandle attackerHandle, BotHandle targetHandle)
+{
+	EpochGuard epoch(reclamation);
+
+	Bot* attacker = botPool.get(attackerHandle);
+	Bot* target = botPool.get(targetHandle);
+
+	if (attacker == nullptr || target == nullptr) {
+		printColoredText("BATTLE FAILED", Color::Red);
+		printLine("Bot {} or bot {} has left the arena", attackerHandle.index, targetHandle.index);
+		return;
+	}
+
+	attack(attacker, target);
+}
+
+// Caller holds an EpochGuard
+void Arena::attack(Bot* attacker, Bot* target)
+{
+	if (usesMailboxes()) {
+		sendAttack(attacker, target);
+		return;
+	}
+
+	if (getAttackProfile(attacker->getArchetypeType()).areaRadius <= 0) {
+		AttackResult result = applyAttack(attacker, target);
+		logAttack(attacker, target, result);
+
+		if (result.resolved)
+			recordMutation();
+		return;
+	}
+
+	thread_local std::vector<Bot*> hit;
+	thread_local std::vector<AttackResult> results;
+
+	hit.clear();
+	findAreaTargets(*attacker, target, hit);
+	results.assign(hit.size(), AttackResult{});
+
+	applyAreaAttack(attacker, hit, results.data());
+	logAreaAttack(attacker, target, hit, results.data());
+
+	for (const AttackResult& result : results) {
+		if (result.resolved)
+			recordMutation();
+	}
+}
+
+// Caller holds an EpochGuard, which keeps the targets' mailboxes alive even if they leave meanwhile
+void Arena::sendAttack(Bot* attacker, Bot* target)
+{
+	thread_local std::vector<Bot*> hit;
+
+	hit.clear();
+	if (getAttackProfile(attacker->getArchetypeType()).areaRadius > 0)
+		findAreaTargets(*attacker, target, hit);
+	else
+		hit.push_back(target);
+
+	// Power at the moment of the attack - a buff that wears off before the targets' turns still counts
+	BotMessage message{ BotMessageKind::Damage, attacker->getAttackPower(), std::nullopt, attacker->getId(), std::chrono::steady_clock::now() };
+	for (Bot* other : hit)
+		other->post(message);
+
+	printColoredText("ATTACK SENT", Color::Yellow);
+	printLine("{} attacked {} bots around x: {}, y: {} for {} damage",
+		attacker->getName(), 
+		hit.size(), 
+		target->getX(), 
+		target->getY(), 
+		message.amount
+	);
+}
+
+void Arena::deliverMessages(Bot* bot)
+{
+	auto now = std::chrono::steady_clock::now();
+
+	int delivered = bot->drainMailbox([&](const BotMessage& message) {
+		double delay = std::chrono::duration<double, std::milli>(now - message.sentAt).count();
+
+		switch (message.kind) {
+			case BotMessageKind::Damage: {
+				StatChange change = bot->takeDamage(message.amount);
+				if (!change)
+					return; // Already defeated by an earlier message
+
+				printColoredText("BATTLE RESULT", Color::Yellow);
+				printLine("{} took an attack of bot {} for {} damage, {:.0f} ms after it was sent. Health: {} -> {}", 
+					bot->getName(), 
+					message.senderId, 
+					message.amount, 
+					delay, 
+					change.previous, 
+					change.current
+				);
+
+				if (change.defeated) {
+					printColoredText("BOT DEFEATED", Color::Magenta);
+					printLine("{} has been defeated!", bot->getName());
+				}
+				break;
+			}
+			case BotMessageKind::Heal: {
+				StatChange change = bot->heal(message.amount);
+				if (!change)
+					return;
+
+				printColoredText("BOT HEALED", Color::Green);
+				printLine("{} healed from {} to {} health", bot->getName(), change.previous, change.current);
+				break;
+			}
+			case BotMessageKind::BuffExpired: {
+				BuffType type = *message.buff;
+				StatChange change = bot->removeBuff(type);
+				if (!change)
+					return;
+
+				printColoredText("BUFF EXPIRED", Color::Blue);
+				printLine("{} {} wore off, {} from {} to {}", 
+					bot->getName(), 
+					getBuffStats(type).name, 
+					getBuffStats(type).stat, 
+					change.previous, 
+					change.current
+				);
+				break;
+			}
+		}
+
+		recordMutation();
+	});
+
+	if (delivered > 0)
+		arenaMetrics.messages.increment(delivered);
+}
+
+void Arena::findTargets(const Bot& attacker, std::vector<Bot*>& targets) const
 {
-	auto& attacker = botList[botIndex];
-	auto& target = botList[targetBotIndex];
+	int range = getAttackProfile(attacker.getArchetypeType()).range;
+	auto [x, y] = attacker.getPosition();
 
+	bots.forEachEnemyInRect(attacker.getFaction(), x - range, y - range, x + range, y + range, [&](Bot* other) {
+		if (other != &attacker)
+			targets.push_back(other);
+	});
+}
+
+void Arena::findAreaTargets(const Bot& attacker, Bot* target, std::vector<Bot*>& targets) const
+{
+	size_t first = targets.size();
+	int radius = getAttackProfile(attacker.getArchetypeType()).areaRadius;
+	auto [x, y] = target->getPosition();
+
+	targets.push_back(target);
+	bots.forEachEnemyInRect(attacker.getFaction(), x - radius, y - radius, x + radius, y + radius, [&](Bot* other) {
+		if (other != &attacker && other != target)
+			targets.push_back(other);
+	});
+
+	// Id order is the lock order. A bot caught mid-move can show up on both of its tiles.
+	std::sort(targets.begin() + first, targets.end(), [](const Bot* a, const Bot* b) { return a->getId() < b->getId(); });
+	targets.erase(std::unique(targets.begin() + first, targets.end()), targets.end());
+}
+
+// Bots are locked in id order, so two area attacks never wait on each other in a cycle. Single-target
+// attacks wait while a bot is locked, heals and buffs do not.
+void Arena::applyAreaAttack(Bot* attacker, std::span<Bot* const> targets, AttackResult* results)
+{
+	if (!attacker->isAlive())
+		return;
+
+	for (Bot* target : targets)
+		target->lockCombat();
+
+	int damage = attacker->getAttackPower();
+	for (size_t i = 0; i < targets.size(); i++) {
+		StatChange change = targets[i]->takeDamageAndUnlock(damage);
+		if (!change)
+			continue;
+
+		results[i].resolved = true;
+		results[i].defeated = change.defeated;
+		results[i].damage = damage;
+		results[i].previousHealth = change.previous;
+		results[i].health = change.current;
+	}
+}
+
+void Arena::logAreaAttack(const Bot* attacker, const Bot* target, std::span<Bot* const> targets, const AttackResult* results)
+{
+	printColoredText("AREA ATTACK", Color::Yellow);
+	printLine("{} hit {} bots around x: {}, y: {}",
+		attacker->getName(), 
+		targets.size(), 
+		target->getX(), 
+		target->getY()
+	);
+
+	for (size_t i = 0; i < targets.size(); i++)
+		logAttack(attacker, targets[i], results[i]);
+}
+
+// Simple battle logic: reduce health of the target bot - touches only the combat words of the two bots and does no logging
+AttackResult Arena::applyAttack(Bot* attacker, Bot* target)
+{
+	AttackResult result;
+
+	// Attacks by or on an already defeated bot are dropped
+	if (!attacker->isAlive())
+		return result;
+
+	int damage = attacker->getAttackPower();
+	StatChange change = target->takeDamage(damage); // Reduce health - one CAS on the target
+	if (!change)
+		return result;
+
+	result.resolved = true;
+	result.defeated = change.defeated; // Exactly one attack sees the bot reach zero
+	result.damage = damage;
+	result.previousHealth = change.previous;
+	result.health = change.current;
+
+	return result;
+}
+
+void Arena::logAttack(const Bot* attacker, const Bot* target, const AttackResult& result)
+{
 	printColoredText("BATTLE", Color::Yellow);
-	std::cout << std::format("{} is battling {} at position x: {}, y: {}",
+	printLine("{} is battling {} at position x: {}, y: {}",
 		attacker->getName(), 
 		target->getName(), 
 		target->getX(), 
 		target->getY()
-	) << std::endl;
+	);
 
-	// Simple battle logic: reduce health of the target bot
-	int previousHealth = target->getHealth();
-	target->takeDamage(attacker->getAttackPower()); // Reduce health
+	if (!result.resolved) {
+		printColoredText("BATTLE FAILED", Color::Red);
+		printLine("{} or {} was already defeated", attacker->getName(), target->getName());
+		return;
+	}
 
 	printColoredText("BATTLE RESULT", Color::Yellow);
-	std::cout << std::format("{} attacked {} for {} damage. {} defense: {}, health: {} -> {}",
+	printLine("{} attacked {} for {} damage. {} defense: {}, health: {} -> {}",
 		attacker->getName(), 
 		target->getName(), 
-		attacker->getAttackPower(), 
+		result.damage, 
 		target->getName(), 
 		target->getDefensePower(), 
-		previousHealth, 
-		target->getHealth()
-	) << std::endl;
+		result.previousHealth, 
+		result.health
+	);
 
-	if (target->getHealth() == 0) {
+	if (result.defeated) {
 		printColoredText("BOT DEFEATED", Color::Magenta);
-		std::cout << std::format("{} has been defeated!", target->getName()) << std::endl;
+		printLine("{} has been defeated!", target->getName());
+	}
+}
+
+// Every live bot with an enemy in range attacks the weakest one, ties go to the lower bot id.
+// Melee bots come from the pair pass, ranged bots ask the bitboards for their attack rectangle.
+void Arena::gatherAttackIntents(std::vector<AttackIntent>& intents)
+{
+	bots.collectAdjacentPairs(adjacentPairs);
+
+	bestTargets.assign(botPool.getSlotCount(), nullptr);
+	auto consider = [this](Bot* attacker, Bot* target) {
+		Bot*& best = bestTargets[attacker->getIdx()];
+		if (best == nullptr
+			|| target->getHealth() < best->getHealth()
+			|| (target->getHealth() == best->getHealth() && target->getId() < best->getId()))
+			best = target;
+	};
+
+	auto isMelee = [this](const Bot* bot) { return getAttackProfile(bot->getArchetypeType()).range <= 1; };
+
+	for (const auto& [first, second] : adjacentPairs) {
+		if (!first->isAlive() || !second->isAlive() || !first->isEnemyOf(*second))
+			continue;
+
+		if (isMelee(first))
+			consider(first, second);
+		if (isMelee(second))
+			consider(second, first);
+	}
+
+	for (Bot* attacker : botPool.live()) {
+		if (attacker == nullptr || !attacker->isAlive() || isMelee(attacker))
+			continue;
+
+		rangedTargets.clear();
+		findTargets(*attacker, rangedTargets);
+		for (Bot* target : rangedTargets) {
+			if (target->isAlive())
+				consider(attacker, target);
+		}
+	}
+
+	// Intents follow the order bots are stored in - this is the sequential order the batch reproduces
+	intents.clear();
+	areaTargets.clear();
+	for (Bot* attacker : botPool.live()) {
+		if (attacker == nullptr || bestTargets[attacker->getIdx()] == nullptr)
+			continue;
+
+		AttackIntent intent{ attacker, bestTargets[attacker->getIdx()] };
+		if (getAttackProfile(attacker->getArchetypeType()).areaRadius > 0) {
+			intent.areaBegin = static_cast<uint32_t>(areaTargets.size());
+			findAreaTargets(*attacker, intent.target, areaTargets);
+			intent.areaCount = static_cast<uint32_t>(areaTargets.size()) - intent.areaBegin;
+		}
+		intents.push_back(intent);
+	}
+}
+
+// Resolve a round of attacks in parallel with the same outcome as resolving them one by one in order.
+// Each intent gets the first group after every earlier intent touching its attacker or any bot it hits (greedy
+// colouring in intent order), so a group never touches a bot twice and each bot sees its attacks in order.
+int Arena::resolveAttacks(const std::vector<AttackIntent>& intents)
+{
+	TimedLockGuard guard(arenaMutex);
+
+	// Colour the attacker/target conflict graph
+	botGroups.assign(botPool.getSlotCount(), -1);
+	intentGroups.resize(intents.size());
+	int numGroups = 0;
+
+	for (size_t i = 0; i < intents.size(); i++) {
+		std::span<Bot* const> hit = getAreaTargets(intents[i]);
+
+		int& attackerGroup = botGroups[intents[i].attacker->getIdx()];
+		int& targetGroup = botGroups[intents[i].target->getIdx()];
+
+		int group = std::max(attackerGroup, targetGroup);
+		for (Bot* bot : hit)
+			group = std::max(group, botGroups[bot->getIdx()]);
+		group++;
+
+		attackerGroup = group;
+		targetGroup = group;
+		for (Bot* bot : hit)
+			botGroups[bot->getIdx()] = group;
+
+		intentGroups[i] = group;
+		numGroups = std::max(numGroups, group + 1);
+	}
+
+	// Bucket intents by group, keeping intent order inside each group
+	groupOffsets.assign(static_cast<size_t>(numGroups) + 1, 0);
+	for (int group : intentGroups)
+		groupOffsets[group + 1]++;
+	for (int g = 0; g < numGroups; g++)
+		groupOffsets[g + 1] += groupOffsets[g];
+
+	groupedIntents.resize(intents.size());
+	groupCursors.assign(groupOffsets.begin(), groupOffsets.end() - 1);
+	for (size_t i = 0; i < intents.size(); i++)
+		groupedIntents[groupCursors[intentGroups[i]]++] = static_cast<int>(i);
+
+	// Resolve the groups in order, the attacks inside a group in parallel
+	attackResults.assign(intents.size(), AttackResult{});
+	areaResults.assign(areaTargets.size(), AttackResult{});
+	ThreadPool& pool = getWorkerPool();
+
+	for (int g = 0; g < numGroups; g++) {
+		const int* group = groupedIntents.data() + groupOffsets[g];
+		size_t groupSize = static_cast<size_t>(groupOffsets[g + 1] - groupOffsets[g]);
+
+		auto resolveRange = [&](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				const AttackIntent& intent = intents[group[k]];
+				if (intent.areaCount > 0)
+					applyAreaAttack(intent.attacker, getAreaTargets(intent), areaResults.data() + intent.areaBegin);
+				else
+					attackResults[group[k]] = applyAttack(intent.attacker, intent.target);
+			}
+		};
+
+		if (groupSize < parallelCombatThreshold)
+			resolveRange(0, groupSize);
+		else
+			pool.parallelFor(groupSize, resolveRange);
+	}
+
+	// Log in the sequential order
+	int defeated = 0;
+	for (size_t i = 0; i < intents.size(); i++) {
+		if (intents[i].areaCount > 0) {
+			const AttackResult* results = areaResults.data() + intents[i].areaBegin;
+			bool resolved = false;
+			for (uint32_t k = 0; k < intents[i].areaCount; k++) {
+				resolved = resolved || results[k].resolved;
+				if (results[k].defeated)
+					defeated++;
+			}
+
+			if (resolved) {
+				intents[i].attacker->getActivity().attacks++;
+				arenaMetrics.attacks.increment();
+				logAreaAttack(intents[i].attacker, intents[i].target, getAreaTargets(intents[i]), results);
+			}
+			continue;
+		}
 
-		target->isAlive = false; // Mark as dead
+		if (attackResults[i].resolved) {
+			intents[i].attacker->getActivity().attacks++;
+			arenaMetrics.attacks.increment();
+			logAttack(intents[i].attacker, intents[i].target, attackResults[i]);
+		}
+		if (attackResults[i].defeated)
+			defeated++;
+	}
+
+	return defeated;
+}
+
+int Arena::resolveCombatRound()
+{
+	{
+		TimedLockGuard guard(arenaMutex);
+		gatherAttackIntents(attackIntents);
+	}
+
+	printColoredText("COMBAT ROUND", Color::Yellow);
+	printLine("{} attacks this round", attackIntents.size());
+
+	return resolveAttacks(attackIntents);
+}
+
+// Lockstep round: every live bot collects, all bots decide at once and their intents are applied
+// in index order, then all attacks are resolved as one batch
+void Arena::playRound()
+{
+	auto start = std::chrono::steady_clock::now();
+	simulationMode = SimulationMode::Lockstep;
+	advanceBuffClock(++roundsPlayed);
+
+	for (Bot* bot : botPool.live()) {
+		if (bot == nullptr)
+			continue;
+
+		bot->getActivity().beginTurn();
+		arenaMetrics.turns.increment();
+		checkAndCollectItem(bot->getHandle());
+	}
+
+	decideAllMoves(roundIntents);
+	applyIntents(roundIntents);
+
+	resolveCombatRound();
+
+	// Defeated bots leave at the end of the round. Round locks are not charged to any bot.
+	TimedLockGuard guard(arenaMutex);
+	for (Bot* bot : botPool.live()) {
+		if (bot == nullptr)
+			continue;
+
+		bot->getActivity().endTurn(0, 0.0);
+		if (!bot->isAlive())
+			removeBot(bot);
+	}
+	botPool.compactIfFragmented();
+
+	// One snapshot per round, whatever the mutation interval
+	publishSnapshot();
+
+	arenaMetrics.roundTime.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+LockstepResult Arena::runLockstep(int itemSpawnRounds, int maxRounds)
+{
+	std::uniform_int_distribution<> distribWidth(0, width - 1);
+	std::uniform_int_distribution<> distribHeight(0, height - 1);
+	std::uniform_int_distribution<> distribItemType(0, static_cast<int>(ItemType::Count) - 1);
+
+	LockstepResult result;
+	while (!isGameOver() && getNumOfBots() > 0 && (maxRounds <= 0 || result.rounds < maxRounds)) {
+		playRound();
+
+		// One draw at a time - the order arguments are evaluated in is unspecified, and partitioned runs repeat these draws
+		if (++result.rounds % itemSpawnRounds == 0) {
+			int x = distribWidth(rng);
+			int y = distribHeight(rng);
+			spawnItem(x, y, static_cast<ItemType>(distribItemType(rng)));
+		}
 	}
+
+	// The winner leaves once the game is over - decided before anyone leaves, or the last bot out would count as a winner
+	TimedLockGuard guard(arenaMutex);
+	result.digest = getStateDigest();
+
+	bool factionWon = bots.getFactionCount() > 0 && bots.getLiveFactionCount() == 1;
+	bool botWon = bots.getCount() == 1;
+
+	for (Bot* bot : botPool.live()) {
+		if (bot == nullptr)
+			continue;
+
+		if (factionWon) {
+			result.decided = true;
+			result.winningFaction = bot->getFaction();
+		}
+		else if (botWon) {
+			result.decided = true;
+			result.winner = bot->getArchetypeType();
+		}
+
+		removeBot(bot);
+	}
+
+	return result;
+}
+
+static uint64_t mixDigest(uint64_t hash, uint64_t value)
+{
+	uint64_t z = (hash ^ value) + 0x9E3779B97F4A7C15ull; // splitmix64
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+uint64_t Arena::digestBot(const Bot& bot)
+{
+	CombatStats stats = bot.getCombatStats();
+
+	uint64_t hash = mixDigest(0, static_cast<uint64_t>(bot.getId()));
+	hash = mixDigest(hash, static_cast<uint64_t>(static_cast<uint32_t>(bot.getX())) << 32 | static_cast<uint32_t>(bot.getY()));
+	hash = mixDigest(hash, static_cast<uint64_t>(stats.health) << 32 | static_cast<uint32_t>(stats.attackPower));
+	hash = mixDigest(hash, static_cast<uint64_t>(stats.defensePower) << 32 | static_cast<uint32_t>(bot.getFaction()));
+	for (int buff : stats.buffs)
+		hash = mixDigest(hash, static_cast<uint64_t>(buff));
+
+	return hash;
 }
 
+uint64_t Arena::digestItem(const Item& item)
+{
+	uint64_t hash = mixDigest(1, static_cast<uint64_t>(static_cast<uint32_t>(item.getX())) << 32 | static_cast<uint32_t>(item.getY()));
+	return mixDigest(hash, static_cast<uint64_t>(item.getType()));
+}
+
+uint64_t Arena::getStateDigest() const
+{
+	EpochGuard epoch(reclamation);
+
+	uint64_t digest = 0;
+	for (const Bot* bot : botPool.live()) {
+		if (bot != nullptr)
+			digest += digestBot(*bot);
+	}
+	for (const Item* item : itemPool.live()) {
+		if (item != nullptr)
+			digest += digestItem(*item);
+	}
+
+	return digest;
+}
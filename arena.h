@@ -1,48 +1,298 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <unordered_map>
 #include <random>
 #include <set>
 #include <iostream>
 #include <format>
 #include <chrono>
+#include <bit>
+#include <memory>
+#include <span>
 
 #include "bot.h"
 #include "item.h"
 #include "utils.h"
 #include "timedMutex.h"
+#include "occupancyGrid.h"
+#include "threadPool.h"
+#include "epochReclamation.h"
+#include "entityPool.h"
+#include "arenaSnapshot.h"
+#include "pathfinder.h"
+#include "distanceField.h"
+#include "timingWheel.h"
 
 // Forward declaration of Bot class
 class Bot;
 
+// Up, Down, Left, Right and Diagonal directions
+constexpr std::array<std::pair<int, int>, 8> adjacentDirections = { {
+	{ -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }
+} };
+
+// Fixed-capacity list of adjacent positions - a bot has at most eight neighbours, so no heap storage is needed
+class BattlePositions {
+private:
+	std::array<std::pair<int, int>, adjacentDirections.size()> positions{};
+	int count = 0;
+
+public:
+	void push_back(const std::pair<int, int>& pos) { positions[count++] = pos; }
+
+	bool empty() const { return count == 0; }
+	int size() const { return count; }
+
+	const std::pair<int, int>& operator[](int index) const { return positions[index]; }
+	const std::pair<int, int>* begin() const { return positions.data(); }
+	const std::pair<int, int>* end() const { return positions.data() + count; }
+};
+
+// How bots are driven - a thread per bot, whole rounds from a single driver thread, or
+// turns scheduled on a timing wheel and run by a few scheduler threads
+enum class SimulationMode {
+	Threaded,
+	Lockstep,
+	Scheduled
+};
+
+// How moveBot commits - decided and applied under arenaMutex, or decided without any lock
+// and committed by validating the version counters of the source and destination tiles
+enum class MoveMode {
+	Locked,
+	Optimistic
+};
+
+// How strategies step towards a target - straight at it, or along a cached A* path around other bots
+enum class PathingMode {
+	Greedy,
+	Pathfinding
+};
+
+// What strategies see - the whole arena, or only the square of their archetype's vision radius around
+// them (fog of war). Limited vision bounds every query by the radius instead of the arena size.
+enum class VisionMode {
+	Global,
+	Limited
+};
+
+// How bots act on each other in the threaded and scheduled modes - the acting thread writes the other
+// bot's combat word, or posts a message to the other bot's mailbox, which the bot applies at the start
+// of its own turn. With mailboxes only a bot's own turn ever writes its stats.
+enum class InteractionMode {
+	Direct,
+	Mailbox
+};
+
+// Move counters since the last reset - retries are optimistic commits that lost a race and re-decided
+struct MoveStats {
+	uint64_t attempts = 0; // moveBot calls for a live bot
+	uint64_t commits = 0;
+	uint64_t retries = 0;
+	uint64_t conflicts = 0; // Moves given up after maxMoveRetries
+};
+
+// Relative weight of each archetype when the arena creates its bots - indexed by BotArchetype
+using ArchetypeMix = std::array<int, static_cast<size_t>(BotArchetype::Count)>;
+constexpr ArchetypeMix evenArchetypeMix = { 1, 1, 1, 1 };
+
+// What one bot did over a game, see Arena::getBotActivity
+struct BotActivityRecord {
+	int id;
+	BotArchetype archetype;
+	int faction;
+	bool survived; // Still alive at the end of the game
+	BotActivity activity;
+};
+
+// Outcome of a lockstep game
+struct LockstepResult {
+	int rounds = 0;
+	bool decided = false; // False when no bot survived or maxRounds ran out
+	BotArchetype winner = BotArchetype::Count; // Free-for-all games
+	int winningFaction = -1; // Team games
+	uint64_t digest = 0; // Hash of the bots and items left after the last round - equal games have equal digests
+};
+
+// Rows one process of a partitioned arena holds: the bots of its slab, and the items of the slab and
+// of the halo rows around it, where its bots can see
+struct ArenaSlab {
+	int begin;
+	int end;
+	int halo;
+
+	bool ownsRow(int y) const { return y >= begin && y < end; }
+	bool seesRow(int y) const { return y >= begin - halo && y < end + halo; }
+};
+
+// Attack chosen for the batch combat phase. An area attack also hits the bots listed in the
+// arena's area target scratch, filled by gatherAttackIntents.
+struct AttackIntent {
+	Bot* attacker;
+	Bot* target;
+	uint32_t areaBegin = 0;
+	uint32_t areaCount = 0; // 0 for single-target attacks
+};
+
+// Outcome of one attack - resolved is false when the attacker or target was already defeated
+struct AttackResult {
+	bool resolved = false;
+	bool defeated = false;
+	int damage = 0;
+	int previousHealth = 0;
+	int health = 0;
+};
+
 class Arena {
 private:
     int width;
     int height;
+	ArenaSlab slab; // Every row unless the arena is a slab of a partitioned arena
 
-    std::unordered_map<std::pair<int, int>, Bot*, pair_hash> bots;
-	std::vector <Bot*> botList; // For easy access to all bots
+	// Outlives reclamation, whose destructor hands the snapshots still retired back to it
+	SnapshotPool snapshotPool;
 
-    std::unordered_map<std::pair<int, int>, Item*, pair_hash> items;
+	// Removed bots and items are retired here instead of deleted, so readers outside
+	// arenaMutex (inside an EpochGuard) can keep using any pointer they loaded.
+	// Declared before the pools, which retire their replaced storage here.
+	mutable EpochManager reclamation;
+
+    OccupancyGrid bots; // Bot on each tile, with bitboard rows for neighbourhood queries
+	EntityPool<Bot> botPool; // Live bots by handle, iterated through botPool.live()
+	std::vector<Bot*> botsByArchetype; // Live bots grouped by archetype for batched strategy evaluation
+	std::vector<Bot*> removedBots; // Left since decideAllMoves last dropped them from botsByArchetype - compared, never dereferenced
+	std::vector<BotActivityRecord> departedActivity; // Bots that left the arena
+	std::vector<Bot*> decidingBots; // Scratch of decideAllMoves - bots in evaluation order
+	std::vector<MoveIntent> batchedIntents; // Scratch of decideAllMoves - intents in evaluation order
+	static constexpr size_t parallelDecisionThreshold = 64; // Fewer bots are decided on the calling thread
+	std::vector<MoveIntent> roundIntents; // Intents of the current lockstep round
+	std::vector<Bot*> botsByIndex; // Live bots by slot index, scratch of applyIntents
+
+	DispatchMode dispatchMode = DispatchMode::Virtual;
+
+	MoveMode moveMode = MoveMode::Locked;
+	PathingMode pathingMode = PathingMode::Pathfinding;
+	VisionMode visionMode = VisionMode::Global;
+	InteractionMode interactionMode = InteractionMode::Direct;
+	SimulationMode simulationMode = SimulationMode::Threaded; // Set by the driver - playRound and runScheduled
+	static constexpr int maxMoveRetries = 8;
+	std::atomic<uint64_t> moveAttempts{ 0 };
+	std::atomic<uint64_t> moveCommits{ 0 };
+	std::atomic<uint64_t> moveRetries{ 0 };
+	std::atomic<uint64_t> moveConflicts{ 0 };
+
+	// Batch combat - workers and per-round scratch buffers
+	std::unique_ptr<ThreadPool> workerPool;
+	int numWorkerThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<int> workerCpus; // Empty leaves the workers floating
+	static constexpr size_t parallelCombatThreshold = 256; // Smaller groups are resolved on the calling thread
+
+	std::vector<std::pair<Bot*, Bot*>> adjacentPairs;
+	std::vector<Bot*> bestTargets;
+	std::vector<Bot*> rangedTargets;
+	std::vector<AttackIntent> attackIntents;
+	std::vector<AttackResult> attackResults;
+	std::vector<int> botGroups;
+	std::vector<int> intentGroups;
+	std::vector<int> groupOffsets;
+	std::vector<int> groupedIntents;
+	std::vector<int> groupCursors; // Next free place of each group in groupedIntents
+	std::vector<Bot*> areaTargets; // Bots hit by the area attacks of the round, each attack's in bot id order
+	std::vector<AttackResult> areaResults; // Parallel to areaTargets
+
+	std::array<AttackProfile, static_cast<size_t>(BotArchetype::Count)> attackProfiles = defaultAttackProfiles;
+
+	std::vector<std::atomic<Item*>> itemTiles; // Item on each tile, row-major
+	EntityPool<Item> itemPool; // Live items by handle
+	std::vector<DistanceField> itemFields; // Distance to the nearest item of each type, indexed by ItemType
+
+	// Read-only consumers (rendering, stats) read published snapshots instead of the live state
+	std::atomic<const ArenaSnapshot*> currentSnapshot{ nullptr };
+	std::atomic<int> pendingMutations{ 0 };
+	static constexpr int defaultSnapshotInterval = 64; // Every publish copies the whole arena under arenaMutex
+	int snapshotInterval = defaultSnapshotInterval; // Mutations between snapshots - 0 publishes only at the end of lockstep rounds
+	uint64_t snapshotVersion = 0;
+
+	// Timed buffs - every pickup schedules its expiry on a timing wheel, so nothing scans the bots for
+	// expired buffs. The wheel runs on the buff clock: one tick per lockstep round, or per
+	// buffTickLength of wall time in the other modes, advanced at the start of every bot turn.
+	static constexpr std::chrono::milliseconds buffTickLength{ 500 }; // About one bot turn
+	std::chrono::steady_clock::time_point buffClockStart = std::chrono::steady_clock::now();
+	uint64_t roundsPlayed = 0;
+	TimingWheel buffExpiries;
+	std::vector<TimerTask> expiredBuffs; // Scratch of advanceBuffClock
+	std::mutex buffMutex; // Guards buffExpiries and expiredBuffs
+
+	ArchetypeMix archetypeMix;
+	std::mt19937 rng; // Setup and lockstep item spawns - a fixed seed replays the same game
 
 	TimedMutex arenaMutex;
 
 	std::unordered_map<std::thread::id, std::chrono::duration<double>> threadExecutionTimeMap;
 
+	friend class PartitionWorker; // Plays one slab of a partitioned arena, see partitionedArena.h
+
+	Arena(int width, int height, int numBots, int numItems, const ArchetypeMix& archetypeMix, uint32_t seed, const ArenaSlab& slab);
+
     void initializeBots(const int numOfBots);
     void initializeItems(const int numOfItems);
+	void assignFactions(const std::vector<int>& sizes); // By bot id, sizes already checked
+
+	Item* getItem(int x, int y) const { return itemTiles[static_cast<size_t>(y) * width + x].load(std::memory_order_acquire); }
+	void addItem(Item* item);
+	void removeItem(Item* item);
+
+	void removeBot(Bot* bot);
+	// A bot crossing into or out of this arena's slab - no logging, the game goes on elsewhere
+	void adoptBot(Bot* bot);
+	void releaseBot(Bot* bot);
+	bool playBotTurn(Bot* bot, std::mt19937& gen);
+	void moveBotOptimistic(BotHandle handle);
+	void commitMove(Bot* bot, std::pair<int, int> moveDirection); // Caller holds arenaMutex
+	void useSkill(Bot* bot, const MoveIntent& intent); // Heal and PowerUp intents
+	void scheduleBuffExpiry(Bot* bot, BuffType type); // Due one buff duration after the current tick
+	void scheduleBuffExpiry(Bot* bot, BuffType type, uint64_t dueTick);
+	void scheduleBuffExpiryLocked(Bot* bot, BuffType type, uint64_t dueTick); // Caller holds buffMutex
+	void expireBuff(BotHandle handle, BuffType type); // Skips a bot that left the arena meanwhile
+	void advanceBuffClock(uint64_t tick); // Expires the buffs due by tick
+	uint64_t getWallBuffTick() const { return static_cast<uint64_t>((std::chrono::steady_clock::now() - buffClockStart) / buffTickLength); }
+	ThreadPool& getWorkerPool();
+
+	void recordMutation() { pendingMutations.fetch_add(1, std::memory_order_relaxed); }
+	void publishSnapshotIfDue(); // Caller holds arenaMutex
+	AttackResult applyAttack(Bot* attacker, Bot* target);
+	// Locks every target, then damages and releases them - no other attack sees part of it. Targets in bot id order.
+	void applyAreaAttack(Bot* attacker, std::span<Bot* const> targets, AttackResult* results);
+	void attack(Bot* attacker, Bot* target); // Single-target or area attack, with logging
+	void sendAttack(Bot* attacker, Bot* target); // InteractionMode::Mailbox - posts the damage to every bot hit
+	void deliverMessages(Bot* bot); // Applies the bot's mailbox - from the bot's own turn only
+	// Bot turns only - a lockstep round has no turn of a bot to read its mailbox in
+	bool usesMailboxes() const { return interactionMode == InteractionMode::Mailbox && simulationMode != SimulationMode::Lockstep; }
+	std::span<Bot* const> getAreaTargets(const AttackIntent& intent) const {
+		return std::span<Bot* const>(areaTargets.data() + intent.areaBegin, intent.areaCount);
+	}
+	void logAttack(const Bot* attacker, const Bot* target, const AttackResult& result);
+	void logAreaAttack(const Bot* attacker, const Bot* target, std::span<Bot* const> targets, const AttackResult* results);
+
+	// Summed over the bots and items, so slabs can digest their own and add the results up
+	static uint64_t digestBot(const Bot& bot);
+	static uint64_t digestItem(const Item& item);
 
 public:
     Arena(int width, int height, int numBots, int numItems);
+	Arena(int width, int height, int numBots, int numItems, const ArchetypeMix& archetypeMix, uint32_t seed);
 
 	~Arena() {
-		for (auto& botPair : bots) {
-			delete botPair.second; // Free memory for each bot
+		for (Bot* bot : botPool.live()) {
+			delete bot; // Free memory for each bot still in the arena
 		}
-		for (auto& itemPair : items) {
-			delete itemPair.second; // Free memory for each item
+		for (Item* item : itemPool.live()) {
+			delete item; // Free memory for each item
 		}
+		delete currentSnapshot.load();
 	}
 
 	std::unordered_map<std::thread::id, std::chrono::duration<double>> getThreadExecutionTimeMap() const {
@@ -53,12 +303,81 @@ public:
 		return arenaMutex.threadWaitMap;
 	}
 
-	// Utility functions
-	std::pair<int, int> getNearestEnemy(int botIndex) const;
-	std::pair<int, int> getWeakestEnemy(int botIndex) const;
-	std::pair<int, int> getNearestItem(int botIndex, ItemType type) const;
-    std::vector<std::pair<int, int>> checkBattles(int botIndex);
-	int getNumOfBots() const { return static_cast<int>(bots.size()); }
+	// Only while no thread is using the arena
+	void setLockPolicy(LockPolicy policy) { arenaMutex.getLock().setPolicy(policy); }
+	LockPolicy getLockPolicy() { return arenaMutex.getLock().getPolicy(); }
+	void resetWaitTimes() { arenaMutex.resetWaitTimes(); }
+
+	void setDispatchMode(DispatchMode mode) { dispatchMode = mode; }
+	DispatchMode getDispatchMode() const { return dispatchMode; }
+
+	void setMoveMode(MoveMode mode) { moveMode = mode; }
+	MoveMode getMoveMode() const { return moveMode; }
+	MoveStats getMoveStats() const { return { moveAttempts.load(), moveCommits.load(), moveRetries.load(), moveConflicts.load() }; }
+	void resetMoveStats() { moveAttempts = 0; moveCommits = 0; moveRetries = 0; moveConflicts = 0; }
+
+	void setPathingMode(PathingMode mode) { pathingMode = mode; }
+	PathingMode getPathingMode() const { return pathingMode; }
+
+	void setVisionMode(VisionMode mode) { visionMode = mode; }
+	VisionMode getVisionMode() const { return visionMode; }
+
+	// Only while no thread is using the arena. Lockstep rounds resolve combat in batches and ignore it.
+	void setInteractionMode(InteractionMode mode) { interactionMode = mode; }
+	InteractionMode getInteractionMode() const { return interactionMode; }
+	// Chebyshev radius the bot's queries are limited to - the whole arena with global vision
+	int getVisionRadius(const Bot& bot) const { return visionMode == VisionMode::Limited ? bot.getVisionRadius() : std::max(width, height); }
+
+	// Only while no thread is using the arena
+	void setAttackProfile(BotArchetype archetype, AttackProfile profile) { attackProfiles[static_cast<size_t>(archetype)] = profile; }
+	const AttackProfile& getAttackProfile(BotArchetype archetype) const { return attackProfiles[static_cast<size_t>(archetype)]; }
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	// Next step of a bot along its cached path to within reach of the target - nullopt when no path exists
+	std::optional<std::pair<int, int>> findPathMove(const Bot& bot, PathCache& path, int targetX, int targetY, int reach) const {
+		return nextPathMove(bots, path, bot.getX(), bot.getY(), targetX, targetY, reach, bot.getSpeed());
+	}
+
+	void setWorkerThreads(int numThreads) { numWorkerThreads = std::max(1, numThreads); workerPool.reset(); }
+	int getWorkerThreads() const { return numWorkerThreads; }
+	void setWorkerCpus(std::vector<int> cpus) { workerCpus = std::move(cpus); workerPool.reset(); } // See ThreadPool
+	const std::vector<int>& getWorkerCpus() const { return workerCpus; }
+
+	// Snapshots - reading never blocks and is never blocked by the simulation
+	SnapshotView getSnapshot() const { return SnapshotView(reclamation, currentSnapshot); }
+	void publishSnapshot(); // Caller holds arenaMutex
+	void setSnapshotInterval(int mutations) { snapshotInterval = std::max(0, mutations); }
+	int getSnapshotInterval() const { return snapshotInterval; }
+
+	// Team games - the first sizes[0] bots by id form faction 0, the next sizes[1] faction 1 and so on.
+	// The sizes must add up to the number of bots. Only before the game starts.
+	bool setFactions(const std::vector<int>& sizes);
+	int getFactionCount() const { return bots.getFactionCount(); }
+
+	// Bot lookup - nullptr once the bot behind the handle has left the arena
+	Bot* getBot(BotHandle handle) const { return botPool.get(handle); }
+	std::vector<BotHandle> getBotHandles() const;
+
+	// Utility functions - safe without arenaMutex, they read inside an EpochGuard. Enemy queries only
+	// look at other factions, through the faction bitboards of the occupancy grid, and only within
+	// the vision radius of the bot. Nothing in sight returns the bot's own position, or (-1, -1) for items.
+	std::pair<int, int> getNearestEnemy(BotHandle handle) const;
+	std::pair<int, int> getWeakestEnemy(BotHandle handle) const;
+	std::pair<int, int> getNearestItem(BotHandle handle, ItemType type) const;
+	// Up to speed steps down the distance field of the item type - nullopt when there is no such item
+	// or every closer tile is taken by a bot
+	std::optional<std::pair<int, int>> getItemFieldMove(const Bot& bot, ItemType type) const;
+    BattlePositions checkBattles(BotHandle handle);
+	// Enemies within attack range of the bot, appended to targets - one rectangle query over the faction bitboards
+	void findTargets(const Bot& attacker, std::vector<Bot*>& targets) const;
+	// The target plus every enemy of the attacker within its area radius of the target, appended in bot id order
+	void findAreaTargets(const Bot& attacker, Bot* target, std::vector<Bot*>& targets) const;
+	void collectAdjacentPairs(std::vector<std::pair<Bot*, Bot*>>& pairs) const { bots.collectAdjacentPairs(pairs); } // Whole-arena pass for batch modes
+	int getNumOfBots() const { return bots.getCount(); }
+	// Every bot of the game, the ones that left included, in id order - only while no thread is using the arena
+	std::vector<BotActivityRecord> getBotActivity() const;
 
 	// Arena state
     void displayArena();            
@@ -66,8 +385,21 @@ public:
 	void spawnItem(int x, int y, ItemType type);
 
 	// Bot function
-    void runBot(int botIndex); // Function each thread will run
-    void moveBot(int botIndex);
-    void checkAndCollectItem(int botIndex);
-	void battle(int botIndex, int targetBotIndex);
+    void runBot(BotHandle handle); // Function each thread will run
+	void runScheduled(int numThreads, int itemSpawnMillis); // Returns when the game is over
+    void moveBot(BotHandle handle);
+	// Strategy of every live bot, evaluated in parallel under arenaMutex so all of them see the same
+	// arena - indexed by bot index. Not for use while bot threads move optimistically.
+	void decideAllMoves(std::vector<MoveIntent>& intents);
+	void applyIntents(const std::vector<MoveIntent>& intents); // In bot index order
+    void checkAndCollectItem(BotHandle handle);
+	void battle(BotHandle attackerHandle, BotHandle targetHandle);
+
+	// Batch combat and lockstep simulation
+	void gatherAttackIntents(std::vector<AttackIntent>& intents); // Caller holds arenaMutex
+	int resolveAttacks(const std::vector<AttackIntent>& intents); // Returns the number of defeated bots
+	int resolveCombatRound();
+	void playRound();
+	LockstepResult runLockstep(int itemSpawnRounds, int maxRounds = 0); // 0 plays until one bot is left
+	uint64_t getStateDigest() const;
 };
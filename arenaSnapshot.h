@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#include "bot.h"
+#include "item.h"
+#include "epochReclamation.h"
+
+struct BotSnapshot {
+	int index;
+	BotArchetype archetype;
+	int x;
+	int y;
+	CombatStats stats;
+	int faction; // -1 in free-for-all games
+};
+
+struct ItemSnapshot {
+	int x;
+	int y;
+	ItemType type;
+};
+
+// Indices into ArenaSnapshot::bots and ArenaSnapshot::items, -1 for an empty tile
+struct TileSnapshot {
+	int32_t bot = -1;
+	int32_t item = -1;
+};
+
+class SnapshotPool;
+
+// Immutable copy of the arena state published by the simulation. A snapshot is never modified after
+// it is published - the next one replaces it and the old one is retired once no reader holds it.
+struct ArenaSnapshot {
+	SnapshotPool* pool = nullptr; // Takes the snapshot back once it is reclaimed
+
+	uint64_t version = 0;
+	int width = 0;
+	int height = 0;
+
+	std::vector<BotSnapshot> bots; // Live bots in pool order
+	std::vector<ItemSnapshot> items;
+	std::vector<TileSnapshot> tiles; // Row-major
+
+	const TileSnapshot& tile(int x, int y) const { return tiles[static_cast<size_t>(y) * width + x]; }
+};
+
+// Reclaimed snapshots wait here to be published again, so a publish refills vectors that already have
+// the capacity instead of allocating new ones. Holds as many as one reclaim pass frees at once.
+class SnapshotPool {
+private:
+	static constexpr size_t capacity = EpochManager::reclaimBatch;
+
+	std::mutex mutex; // Reclaim passes run on whichever thread retires
+	std::vector<ArenaSnapshot*> free;
+
+public:
+	SnapshotPool() { free.reserve(capacity); }
+	~SnapshotPool() {
+		for (ArenaSnapshot* snapshot : free)
+			delete snapshot;
+	}
+
+	SnapshotPool(const SnapshotPool&) = delete;
+	SnapshotPool& operator=(const SnapshotPool&) = delete;
+
+	// A reclaimed snapshot with its old contents, or a new one
+	ArenaSnapshot* acquire() {
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (!free.empty()) {
+				ArenaSnapshot* snapshot = free.back();
+				free.pop_back();
+				return snapshot;
+			}
+		}
+
+		auto* snapshot = new ArenaSnapshot();
+		snapshot->pool = this;
+		return snapshot;
+	}
+
+	// Deleter for EpochManager::retire
+	static void recycle(void* object) {
+		auto* snapshot = static_cast<ArenaSnapshot*>(object);
+		SnapshotPool* pool = snapshot->pool;
+		{
+			std::lock_guard<std::mutex> guard(pool->mutex);
+			if (pool->free.size() < capacity) {
+				pool->free.push_back(snapshot);
+				return;
+			}
+		}
+		delete snapshot;
+	}
+};
+
+// Read access to the latest snapshot - the snapshot current at construction stays valid for the
+// lifetime of the view, however many newer ones are published meanwhile
+class SnapshotView {
+private:
+	EpochGuard epoch; // Entered before the pointer is loaded
+	const ArenaSnapshot* snapshot;
+
+public:
+	SnapshotView(EpochManager& manager, const std::atomic<const ArenaSnapshot*>& current)
+		: epoch(manager), snapshot(current.load(std::memory_order_acquire)) {}
+
+	const ArenaSnapshot& operator*() const { return *snapshot; }
+	const ArenaSnapshot* operator->() const { return snapshot; }
+};
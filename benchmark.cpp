@@ -0,0 +1,988 @@
+// benchmark.cpp : Headless performance measurements of the arena engine.
+//
+// Usage: Benchmark [decisions | adjacency | combat | moves | pathing | affinity | locks | timers | factions | vision | partitioned | mailboxes | all]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <memory>
+
+#include "arena.h"
+#include "partitionedArena.h"
+#include "utils.h"
+#include "cpuAffinity.h"
+
+struct ArenaConfiguration {
+	int width;
+	int height;
+	int numberOfBots;
+};
+
+// Arena sizes and bot counts from the README measurements, plus one large arena
+const std::vector<ArenaConfiguration> configurations = {
+	{ 8, 8, 50 },
+	{ 10, 10, 50 },
+	{ 20, 20, 50 },
+	{ 64, 64, 1000 }
+};
+
+const auto measureDuration = std::chrono::milliseconds(500);
+
+// Strategy decisions per second - runs decideAllMoves rounds for a fixed wall time
+static double measureDecisions(Arena& arena, DispatchMode mode)
+{
+	arena.setDispatchMode(mode);
+
+	std::vector<MoveIntent> intents;
+	long long decisions = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	auto elapsed = std::chrono::high_resolution_clock::duration::zero();
+
+	while (elapsed < measureDuration)
+	{
+		arena.decideAllMoves(intents);
+		decisions += arena.getNumOfBots();
+		elapsed = std::chrono::high_resolution_clock::now() - start;
+	}
+
+	return decisions / std::chrono::duration<double>(elapsed).count();
+}
+
+static void benchmarkDecisions()
+{
+	const int width = 20;
+
+	std::cout << "Strategy decisions per second (virtual vs static archetype dispatch, one thread vs the worker pool)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Virtual"
+		<< std::setw(width) << "Static Batched"
+		<< std::setw(width) << "Speedup"
+		<< std::setw(width) << "Static Parallel"
+		<< std::setw(width) << "Speedup" << "\n";
+
+	for (const auto& config : configurations)
+	{
+		Arena arena(config.width, config.height, config.numberOfBots, 0);
+		int workerThreads = arena.getWorkerThreads();
+
+		arena.setWorkerThreads(1);
+		double virtualRate = measureDecisions(arena, DispatchMode::Virtual);
+		double staticRate = measureDecisions(arena, DispatchMode::Static);
+
+		arena.setWorkerThreads(workerThreads);
+		double parallelRate = measureDecisions(arena, DispatchMode::Static);
+
+		std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+			<< std::setw(width) << config.numberOfBots
+			<< std::setw(width) << std::fixed << std::setprecision(0) << virtualRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << staticRate
+			<< std::setw(width) << std::fixed << std::setprecision(2) << staticRate / virtualRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << parallelRate
+			<< std::setw(width) << std::fixed << std::setprecision(2) << parallelRate / staticRate << "\n";
+	}
+}
+
+// Decisions per second with global vision versus fog of war, for growing arenas at the same bot density.
+// Limited vision bounds every query by the vision radius, so its rate should stay flat.
+static void benchmarkVision()
+{
+	const int width = 20;
+
+	std::cout << "Strategy decisions per second (global vision vs fog of war, one thread)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Global"
+		<< std::setw(width) << "Limited"
+		<< std::setw(width) << "Speedup" << "\n";
+
+	const std::vector<ArenaConfiguration> visionConfigurations = {
+		{ 64, 64, 1000 },
+		{ 128, 128, 4000 },
+		{ 256, 256, 16000 },
+		{ 512, 512, 64000 }
+	};
+
+	for (const auto& config : visionConfigurations)
+	{
+		Arena arena(config.width, config.height, config.numberOfBots, config.numberOfBots / 100);
+		arena.setWorkerThreads(1);
+
+		arena.setVisionMode(VisionMode::Global);
+		double globalRate = measureDecisions(arena, DispatchMode::Static);
+
+		arena.setVisionMode(VisionMode::Limited);
+		double limitedRate = measureDecisions(arena, DispatchMode::Static);
+
+		std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+			<< std::setw(width) << config.numberOfBots
+			<< std::setw(width) << std::fixed << std::setprecision(0) << globalRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << limitedRate
+			<< std::setw(width) << std::fixed << std::setprecision(2) << limitedRate / globalRate << "\n";
+	}
+}
+
+// Per-bot battle detection versus the whole-arena adjacent pair pass, both from the occupancy bitboard
+static void benchmarkAdjacency()
+{
+	const int width = 20;
+
+	std::cout << "Battle detection (per-bot checkBattles vs whole-arena pair pass)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Checks/s"
+		<< std::setw(width) << "Arena Passes/s"
+		<< std::setw(width) << "Adjacent Pairs" << "\n";
+
+	auto adjacencyConfigurations = configurations;
+	adjacencyConfigurations.push_back({ 256, 256, 20000 });
+
+	for (const auto& config : adjacencyConfigurations)
+	{
+		Arena arena(config.width, config.height, config.numberOfBots, 0);
+		std::vector<BotHandle> handles = arena.getBotHandles();
+
+		// Per-bot detection
+		long long checks = 0;
+		long long detectedBattles = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		auto elapsed = std::chrono::high_resolution_clock::duration::zero();
+		while (elapsed < measureDuration)
+		{
+			for (BotHandle handle : handles)
+				detectedBattles += arena.checkBattles(handle).size();
+			checks += config.numberOfBots;
+			elapsed = std::chrono::high_resolution_clock::now() - start;
+		}
+		double checkRate = checks / std::chrono::duration<double>(elapsed).count();
+
+		// Whole-arena pass
+		std::vector<std::pair<Bot*, Bot*>> pairs;
+		long long passes = 0;
+		start = std::chrono::high_resolution_clock::now();
+		elapsed = std::chrono::high_resolution_clock::duration::zero();
+		while (elapsed < measureDuration)
+		{
+			arena.collectAdjacentPairs(pairs);
+			passes++;
+			elapsed = std::chrono::high_resolution_clock::now() - start;
+		}
+		double passRate = passes / std::chrono::duration<double>(elapsed).count();
+
+		std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+			<< std::setw(width) << config.numberOfBots
+			<< std::setw(width) << std::fixed << std::setprecision(0) << checkRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << passRate
+			<< std::setw(width) << pairs.size() << "\n";
+	}
+}
+
+// Enemy queries of one faction in a team game on a 256x256 arena - with the enemy count fixed, the rates
+// should not drop as the faction grows, since queries never look at allies
+static void benchmarkFactions()
+{
+	const int width = 20;
+
+	std::cout << "Team games (enemy queries per second from faction 0)\n";
+	std::cout << std::left << std::setw(width) << "Allies"
+		<< std::setw(width) << "Enemies"
+		<< std::setw(width) << "Nearest Enemy/s"
+		<< std::setw(width) << "Enemy Checks/s"
+		<< std::setw(width) << "Weakest Enemy/s" << "\n";
+
+	const std::vector<std::pair<int, int>> teams = { { 1000, 1000 }, { 10000, 1000 }, { 19000, 1000 }, { 10000, 10000 } };
+
+	for (const auto& [allies, enemies] : teams)
+	{
+		Arena arena(256, 256, allies + enemies, 0);
+		arena.setFactions({ allies, enemies });
+
+		std::vector<BotHandle> handles;
+		for (BotHandle handle : arena.getBotHandles()) {
+			if (arena.getBot(handle)->getFaction() == 0)
+				handles.push_back(handle);
+		}
+
+		// Queries of each kind for measureDuration, cycling through the allies
+		auto measure = [&handles](auto query) {
+			long long queries = 0;
+			long long checksum = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			auto elapsed = std::chrono::high_resolution_clock::duration::zero();
+			while (elapsed < measureDuration)
+			{
+				for (int i = 0; i < 256; i++)
+					checksum += query(handles[(queries + i) % handles.size()]);
+				queries += 256;
+				elapsed = std::chrono::high_resolution_clock::now() - start;
+			}
+			return checksum >= 0 ? queries / std::chrono::duration<double>(elapsed).count() : 0.0;
+		};
+
+		double nearestRate = measure([&arena](BotHandle handle) { return arena.getNearestEnemy(handle).first; });
+		double checkRate = measure([&arena](BotHandle handle) { return arena.checkBattles(handle).size(); });
+		double weakestRate = measure([&arena](BotHandle handle) { return arena.getWeakestEnemy(handle).first; });
+
+		std::cout << std::setw(width) << allies
+			<< std::setw(width) << enemies
+			<< std::setw(width) << std::fixed << std::setprecision(0) << nearestRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << checkRate
+			<< std::setw(width) << std::fixed << std::setprecision(0) << weakestRate << "\n";
+	}
+}
+
+// Attacks resolved per second by the batch combat phase of one crowded round, for growing worker counts
+static void benchmarkCombat()
+{
+	const int width = 20;
+	const int trials = 10;
+
+	std::cout << "Batch combat resolution (attacks per second by worker threads)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Worker Threads"
+		<< std::setw(width) << "Attacks/Round"
+		<< std::setw(width) << "Attacks/s" << "\n";
+
+	const std::vector<ArenaConfiguration> combatConfigurations = {
+		{ 64, 64, 2000 },
+		{ 256, 256, 30000 }
+	};
+
+	int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+	for (const auto& config : combatConfigurations)
+	{
+		for (int threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			std::vector<AttackIntent> intents;
+			long long attacks = 0;
+			auto total = std::chrono::high_resolution_clock::duration::zero();
+
+			// Every trial starts from a fresh arena - attacks change health
+			for (int trial = 0; trial < trials; trial++)
+			{
+				Arena arena(config.width, config.height, config.numberOfBots, 0);
+				arena.setWorkerThreads(threads);
+				arena.gatherAttackIntents(intents);
+
+				auto start = std::chrono::high_resolution_clock::now();
+				arena.resolveAttacks(intents);
+				total += std::chrono::high_resolution_clock::now() - start;
+
+				attacks += intents.size();
+			}
+
+			std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+				<< std::setw(width) << config.numberOfBots
+				<< std::setw(width) << threads
+				<< std::setw(width) << attacks / trials
+				<< std::setw(width) << std::fixed << std::setprecision(0) << attacks / std::chrono::duration<double>(total).count() << "\n";
+		}
+	}
+}
+
+// Concurrent moveBot throughput with the global lock vs optimistic tile-version commits
+static void benchmarkMoves()
+{
+	const int width = 20;
+	const int numThreads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+
+	std::cout << "Concurrent moves per second (" << numThreads << " threads, locked vs optimistic commits)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Move Mode"
+		<< std::setw(width) << "Move Calls/s"
+		<< std::setw(width) << "Committed/s"
+		<< std::setw(width) << "Retry Rate (%)"
+		<< std::setw(width) << "Gave Up" << "\n";
+
+	for (const auto& config : configurations)
+	{
+		for (MoveMode mode : { MoveMode::Locked, MoveMode::Optimistic })
+		{
+			Arena arena(config.width, config.height, config.numberOfBots, 0);
+			arena.setMoveMode(mode);
+			std::vector<BotHandle> handles = arena.getBotHandles();
+
+			// Every thread drives its own share of the bots, like the bot threads do
+			std::atomic<bool> stop{ false };
+			std::atomic<long long> calls{ 0 };
+			std::vector<std::thread> threads;
+			auto start = std::chrono::high_resolution_clock::now();
+
+			for (int t = 0; t < numThreads; t++)
+			{
+				threads.emplace_back([&, t] {
+					while (!stop.load(std::memory_order_relaxed))
+					{
+						for (size_t i = t; i < handles.size(); i += numThreads)
+							arena.moveBot(handles[i]);
+						calls.fetch_add((handles.size() + numThreads - 1 - t) / numThreads, std::memory_order_relaxed);
+					}
+				});
+			}
+
+			std::this_thread::sleep_for(measureDuration);
+			stop = true;
+			for (auto& thread : threads)
+				thread.join();
+
+			double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			MoveStats stats = arena.getMoveStats();
+			uint64_t attempts = stats.commits + stats.retries;
+
+			std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+				<< std::setw(width) << config.numberOfBots
+				<< std::setw(width) << (mode == MoveMode::Locked ? "Locked" : "Optimistic")
+				<< std::setw(width) << std::fixed << std::setprecision(0) << calls / elapsed
+				<< std::setw(width) << stats.commits / elapsed
+				<< std::setw(width) << std::setprecision(2) << (attempts > 0 ? stats.retries * 100.0 / attempts : 0.0)
+				<< std::setw(width) << stats.conflicts << "\n";
+		}
+	}
+}
+
+// Locked moveBot throughput and the spread of per-thread wait times for each arenaMutex policy -
+// one thread per bot, like the threaded simulation, over the arena sizes and bot counts of the README table
+static void benchmarkLocks()
+{
+	const int width = 20;
+	const std::vector<int> arenaSizes = { 8, 10, 20 };
+	const std::vector<int> botCounts = { 2, 10, 50 };
+	const std::vector<std::pair<LockPolicy, std::string_view>> policies = {
+		{ LockPolicy::Std, "std::mutex" },
+		{ LockPolicy::SpinThenPark, "Spin-Then-Park" },
+		{ LockPolicy::Ticket, "Ticket (FIFO)" }
+	};
+
+	std::cout << "Arena lock policies (locked moveBot calls, one thread per bot)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Lock Policy"
+		<< std::setw(width) << "Move Calls/s"
+		<< std::setw(width) << "Mean Wait (ms)"
+		<< std::setw(width) << "Wait Stddev (ms)"
+		<< std::setw(width) << "Max/Min Wait" << "\n";
+
+	for (int size : arenaSizes)
+	{
+		for (int numberOfBots : botCounts)
+		{
+			for (const auto& [policy, name] : policies)
+			{
+				Arena arena(size, size, numberOfBots, 0);
+				arena.setLockPolicy(policy);
+				arena.resetWaitTimes(); // Setup ran on this thread
+				std::vector<BotHandle> handles = arena.getBotHandles();
+
+				std::atomic<bool> stop{ false };
+				std::atomic<long long> calls{ 0 };
+				std::vector<std::thread> threads;
+				auto start = std::chrono::high_resolution_clock::now();
+
+				for (BotHandle handle : handles)
+				{
+					threads.emplace_back([&, handle] {
+						long long ownCalls = 0;
+						while (!stop.load(std::memory_order_relaxed))
+						{
+							arena.moveBot(handle);
+							ownCalls++;
+						}
+						calls += ownCalls;
+					});
+				}
+
+				std::this_thread::sleep_for(measureDuration);
+				stop = true;
+				for (auto& thread : threads)
+					thread.join();
+
+				double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+				// Spread of the total wait of each thread
+				std::vector<double> waits;
+				for (const auto& [id, wait] : arena.getThreadWaitTimeMap())
+					waits.push_back(std::chrono::duration<double, std::milli>(wait).count());
+
+				double mean = 0;
+				for (double wait : waits)
+					mean += wait;
+				mean /= std::max<size_t>(1, waits.size());
+
+				double variance = 0;
+				for (double wait : waits)
+					variance += (wait - mean) * (wait - mean);
+				variance /= std::max<size_t>(1, waits.size());
+
+				auto [minWait, maxWait] = std::minmax_element(waits.begin(), waits.end());
+				double spread = waits.empty() || *minWait <= 0 ? 0.0 : *maxWait / *minWait;
+
+				std::cout << std::setw(width) << std::format("{}x{}", size, size)
+					<< std::setw(width) << numberOfBots
+					<< std::setw(width) << name
+					<< std::setw(width) << std::fixed << std::setprecision(0) << calls / elapsed
+					<< std::setw(width) << std::setprecision(2) << mean
+					<< std::setw(width) << std::sqrt(variance)
+					<< std::setw(width) << spread << "\n";
+			}
+		}
+	}
+}
+
+// Timing wheel versus a binary heap of due times - nanoseconds per timer as the number of pending timers grows.
+// Half of the wheel's timers are cancelled before they fire, which a heap can only do lazily.
+static void benchmarkTimers()
+{
+	const int width = 20;
+	const uint64_t horizon = 100000; // Due ticks are spread over this many ticks
+
+	std::cout << "Timers (ns per timer - wheel insert, cancel and expiry vs heap push and pop)\n";
+	std::cout << std::left << std::setw(width) << "Pending Timers"
+		<< std::setw(width) << "Wheel Insert"
+		<< std::setw(width) << "Wheel Cancel"
+		<< std::setw(width) << "Wheel Expire"
+		<< std::setw(width) << "Heap Push"
+		<< std::setw(width) << "Heap Pop" << "\n";
+
+	auto nanosecondsPer = [](auto duration, size_t count) {
+		return std::chrono::duration<double, std::nano>(duration).count() / std::max<size_t>(1, count);
+	};
+
+	for (size_t count : { 1000, 10000, 100000, 1000000 })
+	{
+		std::mt19937_64 gen(42);
+		std::vector<uint64_t> dueTicks(count);
+		for (uint64_t& due : dueTicks)
+			due = 1 + gen() % horizon;
+
+		long long fired = 0;
+		TimingWheel wheel;
+		std::vector<TimerHandle> handles(count);
+		std::vector<TimerTask> expired;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < count; i++)
+			handles[i] = wheel.schedule(dueTicks[i], [&fired] { fired++; });
+		auto inserted = std::chrono::high_resolution_clock::now();
+
+		for (size_t i = 0; i < count; i += 2)
+			wheel.cancel(handles[i]);
+		auto cancelled = std::chrono::high_resolution_clock::now();
+
+		wheel.advance(horizon, expired);
+		for (TimerTask& task : expired)
+			task();
+		auto advanced = std::chrono::high_resolution_clock::now();
+
+		std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> heap;
+
+		auto heapStart = std::chrono::high_resolution_clock::now();
+		for (uint64_t due : dueTicks)
+			heap.push(due);
+		auto pushed = std::chrono::high_resolution_clock::now();
+
+		while (!heap.empty())
+		{
+			fired += heap.top() > horizon;
+			heap.pop();
+		}
+		auto popped = std::chrono::high_resolution_clock::now();
+
+		std::cout << std::setw(width) << count
+			<< std::setw(width) << std::fixed << std::setprecision(1) << nanosecondsPer(inserted - start, count)
+			<< std::setw(width) << nanosecondsPer(cancelled - inserted, count / 2)
+			<< std::setw(width) << nanosecondsPer(advanced - cancelled, count - count / 2)
+			<< std::setw(width) << nanosecondsPer(pushed - heapStart, count)
+			<< std::setw(width) << nanosecondsPer(popped - pushed, count) << "\n";
+	}
+}
+
+// Lockstep rounds per second of independent arenas, one per thread - a pinned thread builds its arena
+// itself, so the arena lives on the thread's NUMA node
+static double measureIndependentArenas(int numThreads, const std::vector<int>& cpus)
+{
+	const ArenaConfiguration config = { 64, 64, 1000 };
+	const int rounds = 20;
+
+	std::atomic<long long> playedRounds{ 0 };
+	std::vector<std::thread> threads;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads.emplace_back([&, t] {
+			if (!cpus.empty())
+			{
+				pinCurrentThread(cpus[t % cpus.size()]);
+				preferLocalMemory();
+			}
+
+			Arena arena(config.width, config.height, config.numberOfBots, 0);
+			arena.setWorkerThreads(1);
+			arena.setSnapshotInterval(0);
+			playedRounds += arena.runLockstep(5, rounds).rounds;
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return playedRounds / std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Batch combat attacks per second on the worker pool - the measuring thread pins itself to the caller's CPU
+static double measurePinnedCombat(int numThreads, const std::vector<int>& cpus)
+{
+	const ArenaConfiguration config = { 256, 256, 30000 };
+	double rate = 0;
+
+	std::thread measure([&] {
+		if (!cpus.empty())
+		{
+			pinCurrentThread(cpus[0]);
+			preferLocalMemory();
+		}
+
+		Arena arena(config.width, config.height, config.numberOfBots, 0);
+		arena.setWorkerThreads(numThreads);
+		arena.setWorkerCpus(cpus);
+
+		std::vector<AttackIntent> intents;
+		arena.gatherAttackIntents(intents);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		arena.resolveAttacks(intents);
+		rate = intents.size() / std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	});
+
+	measure.join();
+	return rate;
+}
+
+// Floating versus pinned threads, for independent arenas and for the combat worker pool
+static void benchmarkAffinity()
+{
+	const int width = 20;
+	const std::vector<int> cpus = getAvailableCpus();
+	int maxThreads = static_cast<int>(cpus.size());
+
+	std::cout << std::format("Thread pinning ({} CPUs, NUMA {})\n", cpus.size(), isNumaAvailable() ? "available" : "not available");
+	std::cout << std::left << std::setw(width) << "Workload"
+		<< std::setw(width) << "Threads"
+		<< std::setw(width) << "Floating"
+		<< std::setw(width) << "Pinned"
+		<< std::setw(width) << "Speedup" << "\n";
+
+	auto printRow = [&](std::string_view workload, int threads, double floating, double pinned) {
+		std::cout << std::setw(width) << workload
+			<< std::setw(width) << threads
+			<< std::setw(width) << std::fixed << std::setprecision(0) << floating
+			<< std::setw(width) << std::fixed << std::setprecision(0) << pinned
+			<< std::setw(width) << std::fixed << std::setprecision(2) << pinned / floating << "\n";
+	};
+
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+		printRow("Arenas (rounds/s)", threads, measureIndependentArenas(threads, {}), measureIndependentArenas(threads, cpus));
+
+	printRow("Combat (attacks/s)", maxThreads, measurePinnedCombat(maxThreads, {}), measurePinnedCombat(maxThreads, cpus));
+}
+
+// Share of moves that land in lockstep games - greedy steps vs cached A* paths around other bots
+static void benchmarkPathing()
+{
+	const int width = 20;
+	const int trials = 5;
+	const int rounds = 50;
+
+	std::cout << "Move success in lockstep games (" << rounds << " rounds, greedy vs pathfinding)\n";
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Pathing"
+		<< std::setw(width) << "Move Calls"
+		<< std::setw(width) << "Success (%)"
+		<< std::setw(width) << "Rounds/s" << "\n";
+
+	for (const auto& config : configurations)
+	{
+		for (PathingMode mode : { PathingMode::Greedy, PathingMode::Pathfinding })
+		{
+			MoveStats total;
+			long long playedRounds = 0;
+			auto elapsed = std::chrono::high_resolution_clock::duration::zero();
+
+			for (int trial = 0; trial < trials; trial++)
+			{
+				Arena arena(config.width, config.height, config.numberOfBots, 0);
+				arena.setPathingMode(mode);
+
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int round = 0; round < rounds && !arena.isGameOver(); round++, playedRounds++)
+					arena.playRound();
+				elapsed += std::chrono::high_resolution_clock::now() - start;
+
+				MoveStats stats = arena.getMoveStats();
+				total.attempts += stats.attempts;
+				total.commits += stats.commits;
+			}
+
+			std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+				<< std::setw(width) << config.numberOfBots
+				<< std::setw(width) << (mode == PathingMode::Greedy ? "Greedy" : "Pathfinding")
+				<< std::setw(width) << total.attempts / trials
+				<< std::setw(width) << std::fixed << std::setprecision(2) << (total.attempts > 0 ? total.commits * 100.0 / total.attempts : 0.0)
+				<< std::setw(width) << std::setprecision(0) << playedRounds / std::chrono::duration<double>(elapsed).count() << "\n";
+		}
+	}
+}
+
+// Lockstep rounds per second of one process versus the arena split into slabs over several processes,
+// every process deciding on one thread. Partitioned times include forking the workers and building their
+// slabs. Equal digests show the partitioned game played the same.
+static void benchmarkPartitioned()
+{
+	const int width = 20;
+	const int rounds = 50;
+
+	std::cout << std::format("Partitioned lockstep ({} rounds, fog of war, greedy steps, one thread per process)\n", rounds);
+	std::cout << std::left << std::setw(width) << "Arena Size"
+		<< std::setw(width) << "Number of Bots"
+		<< std::setw(width) << "Processes"
+		<< std::setw(width) << "Rounds/s"
+		<< std::setw(width) << "Speedup"
+		<< std::setw(width) << "Same Game" << "\n";
+
+	const std::vector<ArenaConfiguration> partitionedConfigurations = {
+		{ 256, 256, 20000 },
+		{ 512, 512, 80000 }
+	};
+
+	for (const auto& arenaConfig : partitionedConfigurations)
+	{
+		PartitionedConfiguration config;
+		config.width = arenaConfig.width;
+		config.height = arenaConfig.height;
+		config.numberOfBots = arenaConfig.numberOfBots;
+		config.numberOfItems = arenaConfig.numberOfBots / 100;
+		config.maxRounds = rounds;
+		config.workerThreads = 1;
+
+		// The single-process arena is gone before the workers are forked
+		LockstepResult single;
+		double singleRate = 0.0;
+		{
+			Arena arena(config.width, config.height, config.numberOfBots, config.numberOfItems, config.archetypeMix, config.seed);
+			arena.setVisionMode(VisionMode::Limited);
+			arena.setPathingMode(PathingMode::Greedy);
+			arena.setWorkerThreads(1);
+			arena.setSnapshotInterval(0);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			single = arena.runLockstep(config.itemSpawnRounds, config.maxRounds);
+			singleRate = single.rounds / std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+
+		std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+			<< std::setw(width) << config.numberOfBots
+			<< std::setw(width) << 1
+			<< std::setw(width) << std::fixed << std::setprecision(1) << singleRate
+			<< std::setw(width) << std::fixed << std::setprecision(2) << 1.0
+			<< std::setw(width) << "-" << "\n";
+
+		for (int partitions : { 2, 4, 8 })
+		{
+			config.partitions = partitions;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			std::optional<LockstepResult> result = runPartitioned(config);
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			if (!result)
+				continue;
+
+			double rate = result->rounds / seconds;
+			bool sameGame = result->rounds == single.rounds && result->digest == single.digest;
+
+			std::cout << std::setw(width) << std::format("{}x{}", config.width, config.height)
+				<< std::setw(width) << config.numberOfBots
+				<< std::setw(width) << partitions
+				<< std::setw(width) << std::fixed << std::setprecision(1) << rate
+				<< std::setw(width) << std::fixed << std::setprecision(2) << rate / singleRate
+				<< std::setw(width) << (sameGame ? "yes" : "NO") << "\n";
+		}
+	}
+}
+
+struct InteractionMeasurement {
+	double perSecond = 0.0;
+	double meanLatency = 0.0; // Microseconds from the attack until the target's health changed
+	double p99Latency = 0.0;
+};
+
+// Bot threads attacking and healing bots owned by other threads, the way runBot does between sleeps.
+// Direct attacks CAS the target's combat word, area attacks lock their targets in id order first.
+// Mailbox attacks are posted, and each thread applies its own bots' mailboxes as it plays their turns.
+// A defeated bot is revived by its thread, so the game never runs out of targets.
+static InteractionMeasurement measureInteractions(int numThreads, int botsPerThread, int areaTargets, InteractionMode mode)
+{
+	using Clock = std::chrono::steady_clock;
+	const int damage = 10;
+	const int healing = 5;
+	const int latencySampling = 8; // Every 8th delivery is timed
+
+	int numberOfBots = numThreads * botsPerThread;
+	std::vector<std::unique_ptr<Bot>> bots;
+	for (int id = 0; id < numberOfBots; id++)
+		bots.emplace_back(createBot(BotArchetype::Warrior, id, 0, 0));
+	const CombatStats fresh = bots.front()->getCombatStats();
+
+	std::atomic<bool> stop{ false };
+	std::atomic<long long> delivered{ 0 };
+	std::vector<std::vector<float>> latencies(numThreads);
+	std::vector<std::thread> threads;
+
+	auto start = Clock::now();
+
+	for (int owner = 0; owner < numThreads; owner++)
+	{
+		threads.emplace_back([&, owner] {
+			std::mt19937 gen(owner + 1);
+			std::uniform_int_distribution<> targetDistrib(0, numberOfBots - 1);
+			std::vector<Bot*> targets;
+			std::vector<float>& ownLatencies = latencies[owner];
+			long long ownDelivered = 0;
+
+			auto record = [&](Clock::duration latency) {
+				if (ownDelivered++ % latencySampling == 0)
+					ownLatencies.push_back(std::chrono::duration<float, std::micro>(latency).count());
+			};
+
+			for (long long turn = 0; !stop.load(std::memory_order_relaxed); turn++)
+			{
+				Bot* bot = bots[owner * botsPerThread + turn % botsPerThread].get();
+
+				if (mode == InteractionMode::Mailbox)
+				{
+					Clock::time_point now = Clock::now();
+					bot->drainMailbox([&](const BotMessage& message) {
+						if (message.kind == BotMessageKind::Damage)
+							bot->takeDamage(message.amount);
+						else
+							bot->heal(message.amount);
+						record(now - message.sentAt);
+					});
+				}
+
+				if (!bot->isAlive())
+					bot->setCombatStats(fresh);
+
+				// Targets of another thread, in id order - the lock order of area attacks
+				int first = targetDistrib(gen);
+				if (numThreads > 1 && first / botsPerThread == owner)
+					first = (first + botsPerThread) % numberOfBots;
+
+				targets.clear();
+				for (int i = 0; i < areaTargets; i++)
+					targets.push_back(bots[(first + i) % numberOfBots].get());
+				std::sort(targets.begin(), targets.end(), [](const Bot* a, const Bot* b) { return a->getId() < b->getId(); });
+
+				// Every other turn heals instead
+				bool heal = turn % 2 != 0;
+				BotMessage message{ heal ? BotMessageKind::Heal : BotMessageKind::Damage, heal ? healing : damage, std::nullopt, -1, {} };
+
+				if (mode == InteractionMode::Mailbox)
+				{
+					message.sentAt = Clock::now();
+					for (Bot* target : targets)
+						target->post(message);
+					continue;
+				}
+
+				Clock::time_point sent = Clock::now();
+				if (heal)
+				{
+					for (Bot* target : targets)
+						target->heal(healing);
+				}
+				else if (targets.size() == 1)
+				{
+					targets.front()->takeDamage(damage);
+				}
+				else
+				{
+					for (Bot* target : targets)
+						target->lockCombat();
+					for (Bot* target : targets)
+						target->takeDamageAndUnlock(damage);
+				}
+
+				Clock::duration latency = Clock::now() - sent;
+				for (size_t i = 0; i < targets.size(); i++)
+					record(latency);
+			}
+
+			delivered += ownDelivered;
+		});
+	}
+
+	std::this_thread::sleep_for(measureDuration);
+	stop = true;
+	for (auto& thread : threads)
+		thread.join();
+
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<float> samples;
+	for (const auto& own : latencies)
+		samples.insert(samples.end(), own.begin(), own.end());
+	std::sort(samples.begin(), samples.end());
+
+	InteractionMeasurement result;
+	result.perSecond = delivered / elapsed;
+	if (!samples.empty())
+	{
+		double total = 0.0;
+		for (float sample : samples)
+			total += sample;
+
+		result.meanLatency = total / samples.size();
+		result.p99Latency = samples[static_cast<size_t>(0.99 * (samples.size() - 1))];
+	}
+
+	return result;
+}
+
+static void benchmarkMailboxes()
+{
+	const int width = 20;
+	const int botsPerThread = 64;
+
+	std::cout << std::format("Bot interactions (attacks and heals on bots of other threads, {} bots per thread)\n", botsPerThread);
+	std::cout << std::left << std::setw(width) << "Threads"
+		<< std::setw(width) << "Attack"
+		<< std::setw(width) << "Interaction"
+		<< std::setw(width) << "Messages/s"
+		<< std::setw(width) << "Mean Latency (us)"
+		<< std::setw(width) << "p99 Latency (us)" << "\n";
+
+	const std::vector<std::pair<InteractionMode, std::string_view>> modes = {
+		{ InteractionMode::Direct, "Direct" },
+		{ InteractionMode::Mailbox, "Mailbox" }
+	};
+
+	for (int numThreads : { 1, 2, 4, 8 })
+	{
+		for (int areaTargets : { 1, 3 })
+		{
+			for (const auto& [mode, name] : modes)
+			{
+				InteractionMeasurement result = measureInteractions(numThreads, botsPerThread, areaTargets, mode);
+
+				std::cout << std::setw(width) << numThreads
+					<< std::setw(width) << (areaTargets == 1 ? "Single" : std::format("Area ({} bots)", areaTargets))
+					<< std::setw(width) << name
+					<< std::setw(width) << std::fixed << std::setprecision(0) << result.perSecond
+					<< std::setw(width) << std::setprecision(2) << result.meanLatency
+					<< std::setw(width) << result.p99Latency << "\n";
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	// Console logging would dominate every measurement
+	setLoggingEnabled(false);
+
+	std::string_view benchmark = argc > 1 ? argv[1] : "all";
+	bool runAll = benchmark == "all";
+	bool found = runAll;
+
+	if (runAll || benchmark == "decisions")
+	{
+		benchmarkDecisions();
+		found = true;
+	}
+
+	if (runAll || benchmark == "adjacency")
+	{
+		benchmarkAdjacency();
+		found = true;
+	}
+
+	if (runAll || benchmark == "combat")
+	{
+		benchmarkCombat();
+		found = true;
+	}
+
+	if (runAll || benchmark == "moves")
+	{
+		benchmarkMoves();
+		found = true;
+	}
+
+	if (runAll || benchmark == "pathing")
+	{
+		benchmarkPathing();
+		found = true;
+	}
+
+	if (runAll || benchmark == "locks")
+	{
+		benchmarkLocks();
+		found = true;
+	}
+
+	if (runAll || benchmark == "vision")
+	{
+		benchmarkVision();
+		found = true;
+	}
+
+	if (runAll || benchmark == "factions")
+	{
+		benchmarkFactions();
+		found = true;
+	}
+
+	if (runAll || benchmark == "timers")
+	{
+		benchmarkTimers();
+		found = true;
+	}
+
+	if (runAll || benchmark == "affinity")
+	{
+		benchmarkAffinity();
+		found = true;
+	}
+
+	if (runAll || benchmark == "partitioned")
+	{
+		benchmarkPartitioned();
+		found = true;
+	}
+
+	if (runAll || benchmark == "mailboxes")
+	{
+		benchmarkMailboxes();
+		found = true;
+	}
+
+	if (!found)
+	{
+		std::cerr << "Unknown benchmark: " << benchmark << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -1,123 +1,286 @@
 #include "bot.h"
 #include "arena.h"
 
-Bot::Bot(const std::string& name, int x, int y, BotHealth health,
-	BotAttackPower attackPower, BotDefensePower defensePower, BotSpeed speed)
+uint64_t BotActivity::getFailedMoves() const
 {
-	this->name = name;
-	this->x = x;
-	this->y = y;
-	this->idx = -1; // Default index, will be set later
-
-	// Health
-	switch (health) {
-		case BotHealth::Strong:
-			this->health = 100;
-			break;
-		case BotHealth::Normal:
-			this->health = 75;
-			break;
-		case BotHealth::Weak:
-			this->health = 50;
-			break;
-		default:
-			this->health = 0; // Invalid health
-			break;
-	}
+	uint64_t failed = 0;
+	for (uint64_t count : failedMoves)
+		failed += count;
+	return failed;
+}
 
-	// Attack Power
-	switch (attackPower) {
-		case BotAttackPower::High:
-			this->attackPower = 35;
-			break;
-		case BotAttackPower::Medium:
-			this->attackPower = 25;
-			break;
-		case BotAttackPower::Low:
-			this->attackPower = 15;
-			break;
-		default:
-			this->attackPower = 0; // Invalid attack power
-			break;
-	}
+void BotActivity::endTurn(uint64_t acquisitions, double waitSeconds)
+{
+	turns++;
+	lockAcquisitions += acquisitions;
+	lockWaitSeconds += waitSeconds;
 
-	// Defense Power
-	switch (defensePower) {
-		case BotDefensePower::High:
-			this->defensePower = 10;
-			break;
-		case BotDefensePower::Medium:
-			this->defensePower = 5;
-			break;
-		case BotDefensePower::Low:
-			this->defensePower = 2;
-			break;
-		default:
-			this->defensePower = 0; // Invalid defense power
-			break;
+	if (getUsefulActions() == usefulAtTurnStart) {
+		idleTurns++;
+		idleLockAcquisitions += acquisitions;
 	}
+}
 
-	// Speed
-	switch (speed) {
-		case BotSpeed::Normal:
-			this->speed = 1;
-			break;
-		case BotSpeed::Fast:
-			this->speed = 2;
-			break;
-		case BotSpeed::Fly:
-			this->speed = 3; 
-			break;
-		default:
-			this->speed = 0; // Invalid speed
-			break;
-	}
+void BotActivity::merge(const BotActivity& other)
+{
+	turns += other.turns;
+	idleTurns += other.idleTurns;
+	moves += other.moves;
+	for (size_t i = 0; i < failedMoves.size(); i++)
+		failedMoves[i] += other.failedMoves[i];
+	skills += other.skills;
+	emptyBattleChecks += other.emptyBattleChecks;
+	attacks += other.attacks;
+	pickups += other.pickups;
+	lockAcquisitions += other.lockAcquisitions;
+	idleLockAcquisitions += other.idleLockAcquisitions;
+	lockWaitSeconds += other.lockWaitSeconds;
+}
+
+Bot::Bot(const std::string& name, int id, int x, int y, BotArchetype archetype)
+{
+	this->name = name;
+	this->id = id;
+	this->archetype = archetype;
+	this->setPosition(x, y);
+
+	// Stats come from the compile-time archetype tables
+	const ArchetypeStats& stats = getArchetypeStats(archetype);
+	this->combatState.store(packStats({
+		statValue(healthValues, stats.health),
+		statValue(attackPowerValues, stats.attackPower),
+		statValue(defensePowerValues, stats.defensePower),
+		true
+	}));
+	this->speed = statValue(speedValues, stats.speed);
+}
+
+uint64_t Bot::packStats(const CombatStats& stats)
+{
+	uint64_t state = (static_cast<uint64_t>(stats.health) & statMask)
+		| (static_cast<uint64_t>(stats.attackPower) & statMask) << attackShift
+		| (static_cast<uint64_t>(stats.defensePower) & statMask) << defenseShift
+		| (stats.alive ? aliveBit : 0);
+
+	for (size_t buff = 0; buff < stats.buffs.size(); buff++)
+		state |= (static_cast<uint64_t>(stats.buffs[buff]) & buffMask) << (buffShift + buffBits * buff);
+
+	return state;
+}
+
+CombatStats Bot::unpackStats(uint64_t state)
+{
+	CombatStats stats = {
+		static_cast<int>(state & statMask),
+		static_cast<int>((state >> attackShift) & statMask),
+		static_cast<int>((state >> defenseShift) & statMask),
+		(state & aliveBit) != 0
+	};
+
+	for (size_t buff = 0; buff < stats.buffs.size(); buff++)
+		stats.buffs[buff] = static_cast<int>((state >> (buffShift + buffBits * buff)) & buffMask);
+
+	return stats;
 }
 
 void Bot::setPosition(int newX, int newY) 
 {
-    x = newX;
-    y = newY;
+    position.store(static_cast<uint32_t>(newX) | static_cast<uint64_t>(static_cast<uint32_t>(newY)) << 32, std::memory_order_release);
+}
+
+void Bot::setHandle(BotHandle newHandle)
+{
+	handle = newHandle;
 }
 
-void Bot::setIndex(int index)
+// Health after a hit - previous is filled in, applied is left to the caller's CAS
+StatChange Bot::damageStats(CombatStats& stats, int amount)
 {
-	idx = index;
+	StatChange change;
+	change.previous = stats.health;
+
+	int defensePower = stats.defensePower + stats.buffBonus(BuffType::Shield);
+	stats.health -= std::max(0, amount - defensePower); // Reduce health by amount minus defense power - a shield can block a hit, not heal
+	if (stats.health < 0) 
+		stats.health = 0;
+	stats.alive = stats.health > 0;
+
+	change.defeated = !stats.alive; // Only the update that reaches zero flips the flag
+	change.current = stats.health;
+	return change;
 }
 
-void Bot::takeDamage(int amount) 
+StatChange Bot::takeDamage(int amount) 
 {
-	health = health - amount + defensePower; // Reduce health by amount minus defense power
-    if (health < 0) 
-        health = 0;
+	uint64_t state = combatState.load(std::memory_order_acquire);
+
+	while (true) {
+		if ((state & combatLockBit) != 0) {
+			std::this_thread::yield(); // An area attack is hitting the bot
+			state = combatState.load(std::memory_order_acquire);
+			continue;
+		}
+
+		CombatStats stats = unpackStats(state);
+		if (!stats.alive)
+			return StatChange(); // Already dead - nothing to take
+
+		StatChange change = damageStats(stats, amount);
+		if (combatState.compare_exchange_weak(state, packStats(stats), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = true;
+			return change;
+		}
+	}
 }
 
-bool Bot::heal(int amount) 
+void Bot::lockCombat()
 {
-	if (health <= 0)
-	    return false; // Cannot heal if already dead
+	uint64_t state = combatState.load(std::memory_order_relaxed);
 
-    health += amount;
-    if (health > 100) 
-        health = 100;
+	while (true) {
+		if ((state & combatLockBit) != 0) {
+			std::this_thread::yield();
+			state = combatState.load(std::memory_order_relaxed);
+			continue;
+		}
 
-	return true; // Successfully healed
+		if (combatState.compare_exchange_weak(state, state | combatLockBit, std::memory_order_acquire, std::memory_order_relaxed))
+			return;
+	}
 }
 
-bool Bot::increaseAttackPower(int amount)
+StatChange Bot::takeDamageAndUnlock(int amount)
 {
-	if (health <= 0)
-		return false; // Cannot increase attack power if already dead
+	uint64_t state = combatState.load(std::memory_order_acquire);
+
+	while (true) {
+		// Heals and buffs may still change the word while it is locked
+		CombatStats stats = unpackStats(state);
+		bool alive = stats.alive;
+		StatChange change = alive ? damageStats(stats, amount) : StatChange();
+
+		if (combatState.compare_exchange_weak(state, packStats(stats), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = alive;
+			return change;
+		}
+	}
+}
 
-	attackPower += amount;
-	if (attackPower > 100)
-		attackPower = 100;
+StatChange Bot::heal(int amount) 
+{
+	StatChange change;
+	uint64_t state = combatState.load(std::memory_order_acquire);
+
+	while (true) {
+		CombatStats stats = unpackStats(state);
+		if (!stats.alive || stats.health <= 0)
+			return change; // Cannot heal if already dead
+
+		change.previous = stats.health;
+		stats.health += amount;
+		if (stats.health > 100) 
+			stats.health = 100;
+
+		if (combatState.compare_exchange_weak(state, repackStats(stats, state), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = true; // Successfully healed
+			change.current = stats.health;
+			return change;
+		}
+	}
+}
 
-	return true; // Successfully increased attack power
+StatChange Bot::increaseAttackPower(int amount)
+{
+	StatChange change;
+	uint64_t state = combatState.load(std::memory_order_acquire);
+
+	while (true) {
+		CombatStats stats = unpackStats(state);
+		if (!stats.alive || stats.health <= 0)
+			return change; // Cannot increase attack power if already dead
+
+		change.previous = stats.attackPower;
+		stats.attackPower += amount;
+		if (stats.attackPower > 100)
+			stats.attackPower = 100;
+
+		if (combatState.compare_exchange_weak(state, repackStats(stats, state), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = true; // Successfully increased attack power
+			change.current = stats.attackPower;
+			return change;
+		}
+	}
 }
 
-std::pair<int, int> Bot::calculateMove(int targetX, int targetY, int botReduction) const
+// Value of the stat a buff raises, with the buffs in stats
+static int buffedStat(const CombatStats& stats, BuffType type, int baseSpeed)
 {
+	switch (type) {
+		case BuffType::Shield:
+			return stats.defensePower + stats.buffBonus(type);
+		case BuffType::SpeedBoost:
+			return baseSpeed + stats.buffBonus(type);
+		case BuffType::AttackBuff:
+			return stats.attackPower + stats.buffBonus(type);
+		default:
+			return 0;
+	}
+}
+
+StatChange Bot::addBuff(BuffType type)
+{
+	StatChange change;
+	uint64_t state = combatState.load(std::memory_order_acquire);
+	size_t buff = static_cast<size_t>(type);
+
+	while (true) {
+		CombatStats stats = unpackStats(state);
+		if (!stats.alive || stats.buffs[buff] == static_cast<int>(buffMask))
+			return change; // Dead, or the count would overflow its bits
+
+		change.previous = buffedStat(stats, type, speed);
+		stats.buffs[buff]++;
+
+		if (combatState.compare_exchange_weak(state, repackStats(stats, state), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = true;
+			change.current = buffedStat(stats, type, speed);
+			return change;
+		}
+	}
+}
+
+StatChange Bot::removeBuff(BuffType type)
+{
+	StatChange change;
+	uint64_t state = combatState.load(std::memory_order_acquire);
+	size_t buff = static_cast<size_t>(type);
+
+	while (true) {
+		CombatStats stats = unpackStats(state);
+		if (stats.buffs[buff] == 0)
+			return change; // Nothing left to expire
+
+		change.previous = buffedStat(stats, type, speed);
+		stats.buffs[buff]--;
+
+		if (combatState.compare_exchange_weak(state, repackStats(stats, state), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			change.applied = true;
+			change.current = buffedStat(stats, type, speed);
+			return change;
+		}
+	}
+}
+
+std::pair<int, int> Bot::calculateMove(const Arena& arena, int targetX, int targetY, int botReduction)
+{
+	// Follow a path around other bots - botReduction is how close to the target the path has to end
+	if (arena.getPathingMode() == PathingMode::Pathfinding) {
+		std::optional<std::pair<int, int>> step = arena.findPathMove(*this, pathCache, targetX, targetY, botReduction);
+		if (step)
+			return *step;
+	}
+
+	// Greedy step straight towards the target - also used when no path exists
 	int dx = 0, dy = 0;
 	int speed = getSpeed();
 
@@ -128,129 +291,224 @@ std::pair<int, int> Bot::calculateMove(int targetX, int targetY, int botReductio
 	{
 		dx = (diffX >= speed) ? speed : diffX; // Step of speed if far, else step of diffX
 		if (diffX <= speed)
-			dx -= botReduction; // Reduce dx by botReduction if hunting for enemy since they can't be on the same tile
+			dx = std::max(dx - botReduction, 0); // Stop botReduction short of the target - enemies can't share a tile, ranged bots stay at range
 	}
 	else if (targetX < getX())
 	{
 		dx = (diffX >= speed) ? -speed : -diffX; // Step of speed if far, else step of diffX
 		if (diffX <= speed)
-			dx += botReduction; // Reduce dx by botReduction if hunting for enemy since they can't be on the same tile
+			dx = std::min(dx + botReduction, 0); // Stop botReduction short of the target - enemies can't share a tile, ranged bots stay at range
 	}
 
 	if (targetY > getY())
 	{
 		dy = (diffY >= speed) ? speed : diffY; // Step of speed if far, else step of diffY
 		if (diffY <= speed)
-			dy -= botReduction; // Reduce dy by botReduction if hunting for enemy since they can't be on the same tile
+			dy = std::max(dy - botReduction, 0); // Stop botReduction short of the target - enemies can't share a tile, ranged bots stay at range
 	}
 	else if (targetY < getY())
 	{
 		dy = (diffY >= speed) ? -speed : -diffY; // Step of speed if far, else step of diffY
 		if (diffY <= speed)
-			dy += botReduction; // Reduce dy by botReduction if hunting for enemy since they can't be on the same tile
+			dy = std::min(dy + botReduction, 0); // Stop botReduction short of the target - enemies can't share a tile, ranged bots stay at range
 	}
 
 	return { dx, dy }; // Return the calculated move direction
 }
 
-std::pair<int, int> WarriorBot::decideMove(const Arena& arena)
+std::pair<int, int> Bot::moveTowardsItem(const Arena& arena, ItemType type, std::pair<int, int> itemPos)
+{
+	// Items stand still, so the arena keeps a distance field per type - no search while the way is free
+	std::optional<std::pair<int, int>> step = arena.getItemFieldMove(*this, type);
+	if (step)
+		return *step;
+
+	return calculateMove(arena, itemPos.first, itemPos.second, 0);
+}
+
+std::pair<int, int> Bot::explore(const Arena& arena)
+{
+	auto [x, y] = getPosition();
+
+	// A new waypoint once the bot gets there, a couple of vision radii away so the path search stays local.
+	// Derived from the bot id, so lockstep games replay.
+	if (waypoint.first < 0 || (std::abs(waypoint.first - x) <= 1 && std::abs(waypoint.second - y) <= 1)) {
+		uint64_t z = (static_cast<uint64_t>(getId()) << 32 | ++explorations) * 0x9E3779B97F4A7C15ull; // splitmix64
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		z ^= z >> 31;
+
+		int range = 2 * arena.getVisionRadius(*this);
+		int offsetX = static_cast<int>(z % (2 * range + 1)) - range;
+		int offsetY = static_cast<int>((z >> 32) % (2 * range + 1)) - range;
+		waypoint = { std::clamp(x + offsetX, 0, arena.getWidth() - 1), std::clamp(y + offsetY, 0, arena.getHeight() - 1) };
+	}
+
+	printColoredText("EXPLORING", Color::Gray);
+	return calculateMove(arena, waypoint.first, waypoint.second, 0);
+}
+
+std::pair<int, int> Bot::approach(const Arena& arena, std::pair<int, int> enemy)
+{
+	// Ranged bots hold their ground once the enemy is in range instead of walking up to it
+	int range = arena.getAttackProfile(getArchetypeType()).range;
+	if (std::max(std::abs(enemy.first - getX()), std::abs(enemy.second - getY())) <= range)
+		return { 0, 0 };
+
+	return calculateMove(arena, enemy.first, enemy.second, range);
+}
+
+MoveIntent WarriorBot::decideMove(const Arena& arena)
 {
 	// Logic for Warrior: move towards the nearest enemy
+	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getHandle());
+	if (nearestEnemy == getPosition())
+		return explore(arena); // No enemy in sight
+
 	printColoredText("WARRIOR HUNTING", Color::Gray);
-	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getIdx());
-	return calculateMove(nearestEnemy.first, nearestEnemy.second, 1);
+	return approach(arena, nearestEnemy);
 }
 
-std::pair<int, int> MageBot::decideMove(const Arena& arena)
+MoveIntent MageBot::decideMove(const Arena& arena)
 {
 	// Logic for Mage:
 
 	// Critical health - move towards health potion if available
 	if (getHealth() < 15)
 	{
-		std::pair<int, int> healthPotionPos = arena.getNearestItem(getIdx(), ItemType::Health);
+		std::pair<int, int> healthPotionPos = arena.getNearestItem(getHandle(), ItemType::Health);
 		if (healthPotionPos.first != -1 && healthPotionPos.second != -1) 
 		{
 			printColoredText("MAGE MOVING TO HEALTH POTION", Color::Gray);
-			return calculateMove(healthPotionPos.first, healthPotionPos.second, 0); // Move towards health potion
+			return moveTowardsItem(arena, ItemType::Health, healthPotionPos); // Move towards health potion
 		}
 	}
 	
 	// Low health - stay in place to heal
-	if (getHealth() < 30) {
-		int previousHealth = getHealth();
-		heal(10);
-
-		printColoredText("HEAL", Color::Green);
-		std::cout << std::format("MAGE HEALED - {} healed from {} to {} health using MAGIC", 
-			getName(), 
-			previousHealth, 
-			getHealth()
-		) << std::endl;
-
-		return { 0, 0 };
-	}
+	if (getHealth() < 30)
+		return { IntentAction::Heal, 10 };
 
 	// Otherwise, move towards the nearest enemy
+	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getHandle());
+	if (nearestEnemy == getPosition())
+		return explore(arena); // No enemy in sight
+
 	printColoredText("MAGE HUNTING", Color::Gray);
-	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getIdx());
-	return calculateMove(nearestEnemy.first, nearestEnemy.second, 1);
+	return approach(arena, nearestEnemy);
 }
 
-std::pair<int, int> TankBot::decideMove(const Arena& arena)
+MoveIntent TankBot::decideMove(const Arena& arena)
 {
 	// Logic for Tank:
 
 	// Go for Weapon if health low (if weapon available) and attack power is low
 	if (getHealth() < 40 && getAttackPower() < 50)
 	{
-		std::pair<int, int> weaponPos = arena.getNearestItem(getIdx(), ItemType::Weapon);
+		std::pair<int, int> weaponPos = arena.getNearestItem(getHandle(), ItemType::Weapon);
 		if (weaponPos.first != -1 && weaponPos.second != -1)
 		{
 			printColoredText("TANK MOVING TO WEAPON", Color::Gray);
-			return calculateMove(weaponPos.first, weaponPos.second, 0); // Move towards weapon
+			return moveTowardsItem(arena, ItemType::Weapon, weaponPos); // Move towards weapon
 		}
 	}
 
 	// Otherwise, move towards the weakest enemy
+	std::pair<int, int> nearestEnemy = arena.getWeakestEnemy(getHandle());
+	if (nearestEnemy == getPosition())
+		return explore(arena); // No enemy in sight
+
 	printColoredText("TANK HUNTING", Color::Gray);
-	std::pair<int, int> nearestEnemy = arena.getWeakestEnemy(getIdx());
-	return calculateMove(nearestEnemy.first, nearestEnemy.second, 1);
+	return approach(arena, nearestEnemy);
 }
 
-std::pair<int, int> ArcherBot::decideMove(const Arena& arena)
+MoveIntent ArcherBot::decideMove(const Arena& arena)
 {
 	// Logic for Archer:
 
 	// If health is critical, move towards health potion if available
 	if (getHealth() < 15) 
 	{
-		std::pair<int, int> healthPotionPos = arena.getNearestItem(getIdx(), ItemType::Health);
+		std::pair<int, int> healthPotionPos = arena.getNearestItem(getHandle(), ItemType::Health);
 		if (healthPotionPos.first != -1 && healthPotionPos.second != -1)
 		{
 			printColoredText("ARCHER MOVING TO HEALTH POTION", Color::Gray);
-			return calculateMove(healthPotionPos.first, healthPotionPos.second, 0); // Move towards health potion
+			return moveTowardsItem(arena, ItemType::Health, healthPotionPos); // Move towards health potion
 		}
 	}
 
 	// If health is low, increase attack power until it reaches a certain threshold
 	if (getHealth() < 20 && getAttackPower() < 80)
-	{
-		int previousAttackPower = getAttackPower();
-		increaseAttackPower(5);
+		return { IntentAction::PowerUp, 5 }; // Stay in place to increase attack power
+
+	// Otherwise, move towards the nearest enemy
+	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getHandle());
+	if (nearestEnemy == getPosition())
+		return explore(arena); // No enemy in sight
 
-		printColoredText("POWER UP", Color::Green);
-		std::cout << std::format("ARCHER POWER UP - {} increased attack power from {} to {} using SKILLS", 
-			getName(), 
-			previousAttackPower, 
-			getAttackPower()
-		) << std::endl;
+	printColoredText("ARCHER HUNTING", Color::Gray);
+	return approach(arena, nearestEnemy);
+}
 
-		return { 0, 0 }; // Stay in place to increase attack power
+Bot* createBot(BotArchetype archetype, int id, int x, int y)
+{
+	std::string name = "Bot_" + std::to_string(id) + "_" + std::string(getArchetypeStats(archetype).name);
+
+	switch (archetype) {
+		case BotArchetype::Warrior:
+			return new WarriorBot(name, id, x, y);
+		case BotArchetype::Mage:
+			return new MageBot(name, id, x, y);
+		case BotArchetype::Tank:
+			return new TankBot(name, id, x, y);
+		case BotArchetype::Archer:
+			return new ArcherBot(name, id, x, y);
+		default:
+			return nullptr; // Invalid archetype
 	}
+}
 
-	// Otherwise, move towards the nearest enemy
-	printColoredText("ARCHER HUNTING", Color::Gray);
-	std::pair<int, int> nearestEnemy = arena.getNearestEnemy(getIdx());
-	return calculateMove(nearestEnemy.first, nearestEnemy.second, 1);
+MoveIntent decideMoveStatic(Bot& bot, const Arena& arena)
+{
+	// The archetype classes are final, so these calls bind statically
+	switch (bot.getArchetypeType()) {
+		case BotArchetype::Warrior:
+			return static_cast<WarriorBot&>(bot).decideMove(arena);
+		case BotArchetype::Mage:
+			return static_cast<MageBot&>(bot).decideMove(arena);
+		case BotArchetype::Tank:
+			return static_cast<TankBot&>(bot).decideMove(arena);
+		case BotArchetype::Archer:
+			return static_cast<ArcherBot&>(bot).decideMove(arena);
+		default:
+			return MoveIntent(); // Invalid archetype - stay in place
+	}
+}
+
+// Tight loop over bots of a single archetype
+template <class ArchetypeBot>
+static void decideMovesFor(std::span<Bot* const> group, const Arena& arena, MoveIntent* intents)
+{
+	for (size_t i = 0; i < group.size(); i++)
+		intents[i] = static_cast<ArchetypeBot*>(group[i])->decideMove(arena);
+}
+
+void decideMovesBatched(BotArchetype archetype, std::span<Bot* const> group, const Arena& arena, MoveIntent* intents)
+{
+	switch (archetype) {
+		case BotArchetype::Warrior:
+			decideMovesFor<WarriorBot>(group, arena, intents);
+			break;
+		case BotArchetype::Mage:
+			decideMovesFor<MageBot>(group, arena, intents);
+			break;
+		case BotArchetype::Tank:
+			decideMovesFor<TankBot>(group, arena, intents);
+			break;
+		case BotArchetype::Archer:
+			decideMovesFor<ArcherBot>(group, arena, intents);
+			break;
+		default:
+			std::fill(intents, intents + group.size(), MoveIntent()); // Invalid archetype - stay in place
+			break;
+	}
 }
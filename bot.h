@@ -1,10 +1,25 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <atomic>
+#include <array>
+#include <span>
+#include <optional>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+
+#include "entityPool.h"
+#include "mailbox.h"
+#include "pathfinder.h"
+#include "item.h"
 
 // Forward declaration of Arena class
 class Arena;
+class Bot;
+
+using BotHandle = Handle<Bot>;
 
 enum class BotHealth {
     Strong,
@@ -34,6 +49,13 @@ enum class BotSpeed {
 	Count
 };
 
+enum class BotVision {
+	Long,
+	Medium,
+	Short,
+	Count
+};
+
 enum class BotArchetype {
 	Warrior,
 	Mage,
@@ -42,105 +64,308 @@ enum class BotArchetype {
 	Count
 };
 
+// Numeric value of each stat preset - indexed by the enum value
+constexpr std::array<int, static_cast<size_t>(BotHealth::Count)> healthValues = { 100, 75, 50 };
+constexpr std::array<int, static_cast<size_t>(BotAttackPower::Count)> attackPowerValues = { 35, 25, 15 };
+constexpr std::array<int, static_cast<size_t>(BotDefensePower::Count)> defensePowerValues = { 10, 5, 2 };
+constexpr std::array<int, static_cast<size_t>(BotSpeed::Count)> speedValues = { 1, 2, 3 };
+constexpr std::array<int, static_cast<size_t>(BotVision::Count)> visionValues = { 7, 5, 3 }; // Radius in tiles
+
+// Stat presets of each archetype - indexed by BotArchetype
+struct ArchetypeStats {
+	std::string_view name;
+	BotHealth health;
+	BotAttackPower attackPower;
+	BotDefensePower defensePower;
+	BotSpeed speed;
+	BotVision vision;
+};
+
+constexpr std::array<ArchetypeStats, static_cast<size_t>(BotArchetype::Count)> archetypeStats = { {
+	{ "Warrior", BotHealth::Normal, BotAttackPower::High,   BotDefensePower::Medium, BotSpeed::Normal, BotVision::Medium },
+	{ "Mage",    BotHealth::Weak,   BotAttackPower::Medium, BotDefensePower::Low,    BotSpeed::Fly,    BotVision::Long },
+	{ "Tank",    BotHealth::Strong, BotAttackPower::Low,    BotDefensePower::High,   BotSpeed::Normal, BotVision::Short },
+	{ "Archer",  BotHealth::Normal, BotAttackPower::Medium, BotDefensePower::Medium, BotSpeed::Fast,   BotVision::Long }
+} };
+
+// Looks up a stat preset, invalid presets map to 0
+template <class Preset, size_t N>
+constexpr int statValue(const std::array<int, N>& values, Preset preset)
+{
+	auto index = static_cast<size_t>(preset);
+	return index < N ? values[index] : 0;
+}
+
+constexpr const ArchetypeStats& getArchetypeStats(BotArchetype archetype)
+{
+	return archetypeStats[static_cast<size_t>(archetype)];
+}
+
+// Reach of an archetype's attacks
+struct AttackProfile {
+	int range = 1;      // Chebyshev distance to the target - 1 is melee
+	int areaRadius = 0; // Enemies this close to the target are hit as well - 0 for single-target attacks
+};
+
+// Indexed by BotArchetype - the arena starts from these and can change them
+constexpr std::array<AttackProfile, static_cast<size_t>(BotArchetype::Count)> defaultAttackProfiles = { {
+	{ 1, 0 }, // Warrior
+	{ 2, 1 }, // Mage - area attack
+	{ 1, 0 }, // Tank
+	{ 3, 0 }  // Archer - ranged attack
+} };
+
+// Result of an atomic stat update
+struct StatChange {
+	bool applied = false; // False when the bot was already dead
+	bool defeated = false; // takeDamage only - this update is the one that killed the bot
+	int previous = 0;
+	int current = 0;
+
+	explicit operator bool() const { return applied; }
+};
+
+// Interactions sent to a bot's mailbox in InteractionMode::Mailbox, applied by the bot on its own turn.
+// In a game only attacks and buff expiries reach another bot - heals and item effects change the bot
+// acting, on its own turn - so only the mailbox benchmark sends Heal.
+enum class BotMessageKind {
+	Damage,     // Attack power of the attacker when it struck
+	Heal,
+	BuffExpired
+};
+
+struct BotMessage {
+	BotMessageKind kind = BotMessageKind::Damage;
+	int amount = 0;
+	std::optional<BuffType> buff; // BuffExpired only
+	int senderId = -1; // -1 when the arena sent it
+	std::chrono::steady_clock::time_point sentAt;
+};
+
+// Why a step was not taken
+enum class MoveFailure {
+	AlreadyThere, // The strategy stayed put, or the step ran into the arena edge
+	Occupied,
+	Conflict,     // Optimistic commits that lost every retry
+	Count
+};
+
+constexpr std::array<std::string_view, static_cast<size_t>(MoveFailure::Count)> moveFailureNames = { "alreadyThere", "occupied", "conflict" };
+
+// What a bot did. Only the thread playing the bot's turn (or the lockstep round) writes it, so the
+// counters are plain integers - read them once no turn is running.
+struct BotActivity {
+	uint64_t turns = 0;
+	uint64_t idleTurns = 0; // Turns without a useful action
+	uint64_t moves = 0;
+	std::array<uint64_t, static_cast<size_t>(MoveFailure::Count)> failedMoves{};
+	uint64_t skills = 0; // Heals and power-ups
+	uint64_t emptyBattleChecks = 0; // Battle turns without an enemy in range - bot turns only
+	uint64_t attacks = 0;
+	uint64_t pickups = 0;
+	uint64_t lockAcquisitions = 0; // TimedMutex locks taken during the bot's turns - bot turns only
+	uint64_t idleLockAcquisitions = 0; // Of those, in idle turns
+	double lockWaitSeconds = 0.0;
+	uint64_t usefulAtTurnStart = 0; // Scratch of the current turn, not merged
+
+	uint64_t getUsefulActions() const { return moves + skills + attacks + pickups; }
+	uint64_t getFailedMoves() const;
+	void merge(const BotActivity& other);
+
+	void beginTurn() { usefulAtTurnStart = getUsefulActions(); }
+	void endTurn(uint64_t acquisitions, double waitSeconds);
+};
+
+// Snapshot of the combat stats of a bot - attack and defense power without buffs
+struct CombatStats {
+	int health;
+	int attackPower;
+	int defensePower;
+	bool alive;
+	std::array<int, static_cast<size_t>(BuffType::Count)> buffs{}; // Unexpired pickups of each buff
+
+	bool hasBuff(BuffType type) const { return buffs[static_cast<size_t>(type)] > 0; }
+	int buffBonus(BuffType type) const { return hasBuff(type) ? getBuffStats(type).bonus : 0; }
+};
+
+// What a strategy decided for a bot. Strategies only read shared state and the arena applies
+// the intent, so every bot can decide at once
+enum class IntentAction {
+	Move,
+	Heal,   // Mage magic
+	PowerUp // Archer skills
+};
+
+struct MoveIntent {
+	IntentAction action = IntentAction::Move;
+	std::pair<int, int> direction = { 0, 0 };
+	int amount = 0; // Heal and PowerUp only
+
+	MoveIntent() = default;
+	MoveIntent(std::pair<int, int> step) : direction(step) {} // A plain step, so strategies can return a move directly
+	MoveIntent(IntentAction action, int amount) : action(action), amount(amount) {}
+};
+
+// How strategies are dispatched - Virtual goes through the vtable, Static switches on the archetype tag
+enum class DispatchMode {
+	Virtual,
+	Static
+};
+
 class Bot {
 private:
     std::string name;
+	int id; // Creation number - also the bot's number in every process of a partitioned arena
+	BotArchetype archetype;
 
-    int idx;
-    int x;
-    int y;
+	BotHandle handle; // Set when the arena stores the bot
 
-    int health;
-	int attackPower;
-	int defensePower;
+	// x and y packed into one word so readers outside the arena lock never see a torn position
+	std::atomic<uint64_t> position;
+
+	// Health, attack power, defense power, the alive flag and the buff counts packed into one
+	// word - every combat update is a single CAS, so attacks only synchronize on the attacker and
+	// target, and always see the buffs that were active at that moment. The top bit is the combat
+	// lock an area attack holds on every bot it hits: attacks wait for it, other updates keep it.
+	std::atomic<uint64_t> combatState;
 	int speed;
+	int faction = -1; // Team of the bot - -1 in free-for-all games, where every other bot is an enemy
+
+	PathCache pathCache; // Only touched by the thread deciding this bot's move
+	std::pair<int, int> waypoint = { -1, -1 }; // Exploration target while nothing is in sight - same thread as pathCache
+	uint32_t explorations = 0; // Waypoints picked so far
+
+	Mailbox<BotMessage> mailbox; // Posted by any thread, drained by the thread playing the bot's turn
+	BotActivity activity; // Same thread as mailbox
+
+	static constexpr uint64_t statMask = 0xFFFF;
+	static constexpr int attackShift = 16;
+	static constexpr int defenseShift = 32;
+	static constexpr uint64_t aliveBit = uint64_t{ 1 } << 48;
+	static constexpr int buffShift = 49;
+	static constexpr int buffBits = 4;
+	static constexpr uint64_t buffMask = (uint64_t{ 1 } << buffBits) - 1;
+	static constexpr uint64_t combatLockBit = uint64_t{ 1 } << 63;
+	static_assert(buffShift + buffBits * static_cast<int>(BuffType::Count) <= 63);
+
+	static uint64_t packStats(const CombatStats& stats);
+	static CombatStats unpackStats(uint64_t state);
+	static uint64_t repackStats(const CombatStats& stats, uint64_t state) { return packStats(stats) | (state & combatLockBit); } // Keeps the lock
+	static StatChange damageStats(CombatStats& stats, int amount);
 
 public:
-	Bot(const std::string& name, int x, int y, BotHealth health,
-		BotAttackPower attackPower, BotDefensePower defensePower, BotSpeed speed);
+	Bot(const std::string& name, int id, int x, int y, BotArchetype archetype);
 
 	virtual ~Bot() = default;
 
-	std::atomic<bool> isAlive{ true };
-
-	std::string getName() const { return name; }
-	int getIdx() const { return idx; }
-	int getHealth() const { return health; }
-	int getAttackPower() const { return attackPower; }
-	int getDefensePower() const { return defensePower; }
-	int getSpeed() const { return speed; }
-	int getX() const { return x; }
-	int getY() const { return y; }
+	std::string_view getName() const { return name; }
+	std::string_view getArchetype() const { return getArchetypeStats(archetype).name; }
+	BotArchetype getArchetypeType() const { return archetype; }
+	BotHandle getHandle() const { return handle; }
+	int getIdx() const { return static_cast<int>(handle.index); }
+	int getId() const { return id; }
+	CombatStats getCombatStats() const { return unpackStats(combatState.load(std::memory_order_acquire)); }
+	bool isAlive() const { return (combatState.load(std::memory_order_acquire) & aliveBit) != 0; }
+	int getHealth() const { return getCombatStats().health; }
+	// Buffs included
+	int getAttackPower() const { CombatStats stats = getCombatStats(); return stats.attackPower + stats.buffBonus(BuffType::AttackBuff); }
+	int getDefensePower() const { CombatStats stats = getCombatStats(); return stats.defensePower + stats.buffBonus(BuffType::Shield); }
+	int getSpeed() const { return speed + getCombatStats().buffBonus(BuffType::SpeedBoost); }
+	int getVisionRadius() const { return statValue(visionValues, getArchetypeStats(archetype).vision); }
+	int getFaction() const { return faction; }
+	bool isEnemyOf(const Bot& other) const { return &other != this && (faction < 0 || other.faction != faction); }
+	std::pair<int, int> getPosition() const {
+		uint64_t packed = position.load(std::memory_order_acquire);
+		return { static_cast<int32_t>(static_cast<uint32_t>(packed)), static_cast<int32_t>(packed >> 32) };
+	}
+	int getX() const { return getPosition().first; }
+	int getY() const { return getPosition().second; }
 
     void setPosition(int newX, int newY);
-    void setIndex(int index);
+    void setHandle(BotHandle newHandle);
+	void setFaction(int newFaction) { faction = newFaction; } // Only before the game starts
+
+	// State a copy of the bot in another process needs - only for bots that are not in play
+	void setCombatStats(const CombatStats& stats) { combatState.store(packStats(stats), std::memory_order_release); }
+	std::pair<int, int> getWaypoint() const { return waypoint; }
+	uint32_t getExplorations() const { return explorations; }
+	void setExploration(std::pair<int, int> newWaypoint, uint32_t newExplorations) { waypoint = newWaypoint; explorations = newExplorations; }
+
+    StatChange takeDamage(int amount); // Waits while an area attack holds the bot
+
+	// Area attacks lock every bot they hit, in bot id order, then damage and release each one
+	void lockCombat();
+	StatChange takeDamageAndUnlock(int amount);
+    StatChange heal(int amount);
+    StatChange increaseAttackPower(int amount);
+	// One more or one fewer unexpired pickup of the buff - previous and current are the buffed stat
+	StatChange addBuff(BuffType type);
+	StatChange removeBuff(BuffType type);
 
-    void takeDamage(int amount);
-    bool heal(int amount);
-    bool increaseAttackPower(int amount);
-	std::pair<int, int> calculateMove(int targetX, int targetY, int botReduction) const;
+	BotActivity& getActivity() { return activity; }
+	const BotActivity& getActivity() const { return activity; }
+
+	void post(const BotMessage& message) { mailbox.post(message); }
+	template <class Apply>
+	int drainMailbox(Apply&& apply) { return mailbox.drain(std::forward<Apply>(apply)); }
+	std::pair<int, int> calculateMove(const Arena& arena, int targetX, int targetY, int botReduction);
+	std::pair<int, int> moveTowardsItem(const Arena& arena, ItemType type, std::pair<int, int> itemPos);
+	std::pair<int, int> explore(const Arena& arena); // Nothing in sight - wander between random waypoints
+	std::pair<int, int> approach(const Arena& arena, std::pair<int, int> enemy); // Closes in until the enemy is within attack range
 
 	// Virtual methods for bot archetypes
-	virtual std::string getArchetype() const = 0;
-	virtual std::pair<int, int> decideMove(const Arena& arena) = 0;
+	virtual MoveIntent decideMove(const Arena& arena) = 0;
 };
 
 // Warrior
-class WarriorBot : public Bot {
+class WarriorBot final : public Bot {
 public:
-	WarriorBot(const std::string& name, int x, int y)
-	: Bot(name, x, y, BotHealth::Normal, BotAttackPower::High, BotDefensePower::Medium, BotSpeed::Normal)
+	WarriorBot(const std::string& name, int id, int x, int y)
+		: Bot(name, id, x, y, BotArchetype::Warrior)
 	{
 	}
 
-	std::string getArchetype() const override {
-		return "Warrior";
-	}
-
-	std::pair<int, int> decideMove(const Arena& arena) override;
+	MoveIntent decideMove(const Arena& arena) override;
 };
 
 // Mage
-class MageBot : public Bot {
+class MageBot final : public Bot {
 public:
-	MageBot(const std::string& name, int x, int y)
-		: Bot(name, x, y, BotHealth::Weak, BotAttackPower::Medium, BotDefensePower::Low, BotSpeed::Fly)
+	MageBot(const std::string& name, int id, int x, int y)
+		: Bot(name, id, x, y, BotArchetype::Mage)
 	{
 	}
 
-	std::string getArchetype() const override {
-		return "Mage";
-	}
-
-	std::pair<int, int> decideMove(const Arena& arena) override;
+	MoveIntent decideMove(const Arena& arena) override;
 };
 
 // Tank
-class TankBot : public Bot {
+class TankBot final : public Bot {
 public:
-	TankBot(const std::string& name, int x, int y)
-		: Bot(name, x, y, BotHealth::Strong, BotAttackPower::Low, BotDefensePower::High, BotSpeed::Normal)
+	TankBot(const std::string& name, int id, int x, int y)
+		: Bot(name, id, x, y, BotArchetype::Tank)
 	{
 	}
 
-	std::string getArchetype() const override {
-		return "Tank";
-	}
-
-	std::pair<int, int> decideMove(const Arena& arena) override;
+	MoveIntent decideMove(const Arena& arena) override;
 };
 
 // Archer
-class ArcherBot : public Bot {
+class ArcherBot final : public Bot {
 public:
-	ArcherBot(const std::string& name, int x, int y)
-		: Bot(name, x, y, BotHealth::Normal, BotAttackPower::Medium, BotDefensePower::Medium, BotSpeed::Fast)
+	ArcherBot(const std::string& name, int id, int x, int y)
+		: Bot(name, id, x, y, BotArchetype::Archer)
 	{
 	}
 
-	std::string getArchetype() const override {
-		return "Archer";
-	}
-
-	std::pair<int, int> decideMove(const Arena& arena) override;
+	MoveIntent decideMove(const Arena& arena) override;
 };
+
+// Creates the archetype class, named after its id - nullptr for an invalid archetype
+Bot* createBot(BotArchetype archetype, int id, int x, int y);
+
+// Devirtualized strategy dispatch - the archetype tag selects the final class, so each decideMove can be inlined
+MoveIntent decideMoveStatic(Bot& bot, const Arena& arena);
+
+// Runs the strategy of one archetype over a group of bots of that archetype - one branch per group instead of per bot
+void decideMovesBatched(BotArchetype archetype, std::span<Bot* const> group, const Arena& arena, MoveIntent* intents);
@@ -0,0 +1,243 @@
+// checks.cpp : Regression checks for the concurrency and allocation guarantees of the arena.
+// Each check prints CHECK PASSED or CHECK FAILED and sets the exit code - ctest runs them all.
+//
+// Usage: Checks [readers | allocations | defeats | all]
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <format>
+
+#include "arena.h"
+#include "utils.h"
+
+// Every allocation of the process goes through here - counted while a check measures
+static std::atomic<bool> countingAllocations{ false };
+static std::atomic<long long> allocationCount{ 0 };
+
+void* operator new(size_t size)
+{
+	if (countingAllocations.load(std::memory_order_relaxed))
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	void* memory = std::malloc(size == 0 ? 1 : size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+static bool reportCheck(std::string_view name, bool passed)
+{
+	printColoredText(passed ? "CHECK PASSED" : "CHECK FAILED", passed ? Color::Green : Color::Red);
+	std::cout << name << std::endl;
+	return passed;
+}
+
+// More threads than epoch reader slots, each nesting guards: the optimistic move holds one across
+// decideMove, whose queries and snapshot views open their own. Every window must see progress.
+static bool checkReaders()
+{
+	const int numThreads = 2 * EpochManager::maxReaders;
+	const int windows = 8;
+	const auto window = std::chrono::milliseconds(250);
+
+	Arena arena(40, 40, numThreads, 20, evenArchetypeMix, 1);
+	arena.setMoveMode(MoveMode::Optimistic);
+	std::vector<BotHandle> handles = arena.getBotHandles();
+
+	std::atomic<bool> stop{ false };
+	std::atomic<long long> calls{ 0 };
+	std::atomic<int> finished{ 0 };
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads.emplace_back([&, t] {
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				arena.moveBot(handles[t % handles.size()]);
+				calls.fetch_add(1, std::memory_order_relaxed);
+			}
+			finished.fetch_add(1);
+		});
+	}
+
+	// A stuck thread would never finish - joining it would hang the check
+	auto fail = [] {
+		reportCheck("readers: moves stopped completing - epoch slots exhausted", false);
+		std::_Exit(1);
+	};
+
+	for (int i = 0; i < windows; i++)
+	{
+		long long before = calls.load();
+		std::this_thread::sleep_for(window);
+		if (calls.load() == before)
+			fail();
+	}
+
+	stop = true;
+	for (int i = 0; i < windows && finished.load() < numThreads; i++)
+		std::this_thread::sleep_for(window);
+	if (finished.load() < numThreads)
+		fail();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return reportCheck(std::format("readers: {} threads, {} moves", numThreads, calls.load()), true);
+}
+
+// The turn path - item pickup, move, battle check and battle - must not allocate once the arena has
+// warmed up. Warm-up fills the snapshot and entity pools, which only refill after epochs reclaim.
+static bool checkAllocations()
+{
+	const int warmUpRounds = 400;
+	const int measuredRounds = 200;
+	const size_t maxItems = 12; // Items come and go, so pooled buffers see a bounded count
+
+	// Publishing on every mutation also puts the snapshot pool on the turn path
+	Arena arena(16, 16, 40, 0, evenArchetypeMix, 3);
+	arena.setSnapshotInterval(1);
+	std::vector<BotHandle> handles = arena.getBotHandles();
+	std::mt19937 gen(1);
+
+	auto playRound = [&](bool counted) {
+		for (BotHandle handle : handles)
+		{
+			Bot* bot = arena.getBot(handle);
+			if (bot != nullptr && gen() % 3 == 0 && arena.getSnapshot()->items.size() < maxItems)
+				arena.spawnItem(bot->getX(), bot->getY(), static_cast<ItemType>(gen() % static_cast<int>(ItemType::Count)));
+		}
+
+		countingAllocations = counted;
+		for (BotHandle handle : handles)
+		{
+			if (arena.getBot(handle) == nullptr)
+				continue;
+
+			arena.checkAndCollectItem(handle);
+			arena.moveBot(handle);
+			if (!arena.checkBattles(handle).empty())
+				arena.battle(handle, handles[0]);
+		}
+		countingAllocations = false;
+	};
+
+	for (int i = 0; i < warmUpRounds; i++)
+		playRound(false);
+	for (int i = 0; i < measuredRounds; i++)
+		playRound(true);
+
+	long long allocations = allocationCount.load();
+	return reportCheck(std::format("allocations: {} in {} rounds of {} bots after warm-up", allocations, measuredRounds, handles.size()), allocations == 0);
+}
+
+// Threads hit one bot at once with single and area attacks while others heal it - exactly one
+// update may see it defeated, which is the one that prints BOT DEFEATED, and it must stay dead.
+static bool checkDefeats()
+{
+	const int trials = 200;
+	const int numThreads = 8;
+	const int healAmount = 2;
+
+	int deaths = 0;
+	int defeats = 0;
+
+	for (int trial = 0; trial < trials; trial++)
+	{
+		WarriorBot bot("Target", 0, 0, 0);
+		const int damage = bot.getDefensePower() + 3 * healAmount; // Every hit outpaces a heal
+
+		std::atomic<bool> start{ false };
+		std::atomic<int> trialDefeats{ 0 };
+		std::vector<std::thread> threads;
+
+		for (int t = 0; t < numThreads; t++)
+		{
+			threads.emplace_back([&, t] {
+				while (!start.load(std::memory_order_acquire))
+					std::this_thread::yield();
+
+				while (bot.isAlive())
+				{
+					StatChange change;
+					switch (t % 3) {
+						case 0:
+							change = bot.takeDamage(damage);
+							break;
+						case 1:
+							bot.lockCombat();
+							change = bot.takeDamageAndUnlock(damage);
+							break;
+						default:
+							bot.heal(healAmount);
+							break;
+					}
+
+					if (change.defeated)
+						trialDefeats.fetch_add(1);
+				}
+			});
+		}
+
+		start.store(true, std::memory_order_release);
+		for (auto& thread : threads)
+			thread.join();
+
+		if (!bot.isAlive() && bot.getHealth() == 0)
+			deaths++;
+		defeats += trialDefeats.load();
+
+		if (trialDefeats.load() != 1 || bot.isAlive() || bot.getHealth() != 0)
+			return reportCheck(std::format("defeats: trial {} saw {} defeats, health {}", trial, trialDefeats.load(), bot.getHealth()), false);
+	}
+
+	return reportCheck(std::format("defeats: {} deaths under {} threads, {} defeats", deaths, numThreads, defeats), deaths == trials && defeats == deaths);
+}
+
+int main(int argc, char* argv[])
+{
+	setLoggingEnabled(false);
+
+	std::string_view check = argc > 1 ? argv[1] : "all";
+	bool runAll = check == "all";
+	bool found = runAll;
+	bool passed = true;
+
+	if (runAll || check == "readers")
+	{
+		passed = checkReaders() && passed;
+		found = true;
+	}
+
+	if (runAll || check == "allocations")
+	{
+		passed = checkAllocations() && passed;
+		found = true;
+	}
+
+	if (runAll || check == "defeats")
+	{
+		passed = checkDefeats() && passed;
+		found = true;
+	}
+
+	if (!found)
+	{
+		printColoredText("CHECK FAILED", Color::Red);
+		std::cout << "Usage: Checks [readers | allocations | defeats | all]" << std::endl;
+		return 1;
+	}
+
+	return passed ? 0 : 1;
+}
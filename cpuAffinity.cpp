@@ -0,0 +1,137 @@
+#include "cpuAffinity.h"
+
+#include <algorithm>
+#include <charconv>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef ARENA_HAVE_NUMA
+#include <numa.h>
+#endif
+
+std::vector<int> getAvailableCpus()
+{
+	std::vector<int> cpus;
+
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &set))
+				cpus.push_back(cpu);
+		}
+	}
+#endif
+
+	if (cpus.empty()) {
+		int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		for (int cpu = 0; cpu < count; cpu++)
+			cpus.push_back(cpu);
+	}
+
+	std::stable_sort(cpus.begin(), cpus.end(), [](int a, int b) { return getNumaNode(a) < getNumaNode(b); });
+	return cpus;
+}
+
+std::optional<std::vector<int>> parseCpuList(std::string_view text)
+{
+	std::vector<int> cpus;
+
+	auto parseNumber = [](std::string_view field, int& value) {
+		auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+		return error == std::errc() && end == field.data() + field.size() && value >= 0;
+	};
+
+	while (!text.empty()) {
+		size_t comma = text.find(',');
+		std::string_view range = text.substr(0, comma);
+		text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+
+		size_t dash = range.find('-');
+		int first = 0;
+		int last = 0;
+
+		if (dash == std::string_view::npos) {
+			if (!parseNumber(range, first))
+				return std::nullopt;
+			last = first;
+		}
+		else if (!parseNumber(range.substr(0, dash), first) || !parseNumber(range.substr(dash + 1), last) || last < first) {
+			return std::nullopt;
+		}
+
+		for (int cpu = first; cpu <= last; cpu++)
+			cpus.push_back(cpu);
+	}
+
+	if (cpus.empty())
+		return std::nullopt;
+
+	return cpus;
+}
+
+#ifdef __linux__
+static bool pinNativeThread(pthread_t thread, int cpu)
+{
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+#endif
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+	return pinNativeThread(pthread_self(), cpu);
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+bool pinThread(std::thread& thread, int cpu)
+{
+#ifdef __linux__
+	return pinNativeThread(thread.native_handle(), cpu);
+#else
+	(void)thread;
+	(void)cpu;
+	return false;
+#endif
+}
+
+bool isNumaAvailable()
+{
+#ifdef ARENA_HAVE_NUMA
+	return numa_available() >= 0;
+#else
+	return false;
+#endif
+}
+
+int getNumaNode(int cpu)
+{
+#ifdef ARENA_HAVE_NUMA
+	if (isNumaAvailable())
+		return std::max(0, numa_node_of_cpu(cpu));
+#endif
+	(void)cpu;
+	return 0;
+}
+
+void preferLocalMemory()
+{
+#ifdef ARENA_HAVE_NUMA
+	if (isNumaAvailable())
+		numa_set_localalloc();
+#endif
+}
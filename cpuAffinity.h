@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <optional>
+#include <string_view>
+
+// Pinning simulation threads to CPUs, and NUMA placement of the memory they touch.
+// Pinning is implemented on Linux only - elsewhere it reports failure and threads keep floating.
+// NUMA queries need libnuma (ARENA_HAVE_NUMA) - without it every CPU is on node 0.
+
+// CPUs this process may run on, grouped by NUMA node so that neighbouring workers share a node
+std::vector<int> getAvailableCpus();
+
+// Parses a CPU list such as "0-3,8,10-11" - nullopt when malformed
+std::optional<std::vector<int>> parseCpuList(std::string_view text);
+
+bool pinCurrentThread(int cpu);
+bool pinThread(std::thread& thread, int cpu);
+
+bool isNumaAvailable();
+int getNumaNode(int cpu);
+
+// Memory the calling thread touches first is placed on its own node. This is the kernel's
+// first-touch default - with libnuma the local policy is also set explicitly, overriding any
+// interleaving the process was started with.
+void preferLocalMemory();
@@ -0,0 +1,150 @@
+#include "distanceField.h"
+
+#include <array>
+#include <algorithm>
+
+constexpr std::array<std::pair<int, int>, 8> fieldDirections = { {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }
+} };
+
+DistanceField::DistanceField(int width, int height)
+	: width(width), height(height),
+	distances(static_cast<size_t>(width) * height),
+	owners(static_cast<size_t>(width) * height),
+	inRegion(static_cast<size_t>(width) * height, 0),
+	buckets(static_cast<size_t>(std::max(width, height)) + 1)
+{
+	for (auto& distance : distances)
+		distance.store(unreachable, std::memory_order_relaxed);
+	for (auto& owner : owners)
+		owner.store(-1, std::memory_order_relaxed);
+}
+
+std::optional<std::pair<int, int>> DistanceField::getNearestSource(int x, int y) const
+{
+	int32_t owner = owners[tileIndex(x, y)].load(std::memory_order_relaxed);
+	if (owner < 0)
+		return std::nullopt;
+
+	return std::make_pair(owner % width, owner / width);
+}
+
+void DistanceField::relax(int32_t tile, uint16_t distance, int32_t owner)
+{
+	distances[tile].store(distance, std::memory_order_relaxed);
+	owners[tile].store(owner, std::memory_order_relaxed);
+	buckets[distance].push_back(tile);
+}
+
+bool DistanceField::isCloser(int32_t tile, uint16_t distance, int32_t owner) const
+{
+	uint16_t current = distances[tile].load(std::memory_order_relaxed);
+	return distance < current || (distance == current && owner < owners[tile].load(std::memory_order_relaxed));
+}
+
+void DistanceField::flood(uint16_t fromDistance)
+{
+	// Unit steps, so expanding the buckets in order is a BFS from several distances at once
+	for (size_t distance = fromDistance; distance + 1 < buckets.size(); distance++) {
+		auto& bucket = buckets[distance];
+
+		for (size_t i = 0; i < bucket.size(); i++) {
+			int32_t tile = bucket[i];
+			if (distances[tile].load(std::memory_order_relaxed) != distance)
+				continue; // Reached more cheaply since it was queued - a tie won by a lower source is queued again
+
+			int x = tile % width;
+			int y = tile / width;
+			int32_t owner = owners[tile].load(std::memory_order_relaxed);
+
+			for (const auto& [dx, dy] : fieldDirections) {
+				int nx = x + dx;
+				int ny = y + dy;
+				if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+					continue;
+
+				int32_t next = static_cast<int32_t>(tileIndex(nx, ny));
+				if (isCloser(next, static_cast<uint16_t>(distance + 1), owner))
+					relax(next, static_cast<uint16_t>(distance + 1), owner);
+			}
+		}
+
+		bucket.clear();
+	}
+}
+
+void DistanceField::addSource(int x, int y)
+{
+	int32_t source = static_cast<int32_t>(tileIndex(x, y));
+	if (distances[source].load(std::memory_order_relaxed) == 0)
+		return; // Already a source
+
+	// Only the tiles that got closer are visited
+	relax(source, 0, source);
+	flood(0);
+}
+
+void DistanceField::removeSource(int x, int y)
+{
+	int32_t source = static_cast<int32_t>(tileIndex(x, y));
+	if (owners[source].load(std::memory_order_relaxed) != source)
+		return; // Not a source
+
+	// Tiles this source was nearest to - each one has a neighbour owned by it one step closer (a tile's
+	// source is the lowest of its closer neighbours' sources),
+	// so the region is connected and a flood from the source finds all of it
+	region.clear();
+	region.push_back(source);
+	inRegion[source] = 1;
+
+	for (size_t i = 0; i < region.size(); i++) {
+		int tx = region[i] % width;
+		int ty = region[i] / width;
+
+		for (const auto& [dx, dy] : fieldDirections) {
+			int nx = tx + dx;
+			int ny = ty + dy;
+			if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+				continue;
+
+			int32_t next = static_cast<int32_t>(tileIndex(nx, ny));
+			if (!inRegion[next] && owners[next].load(std::memory_order_relaxed) == source) {
+				inRegion[next] = 1;
+				region.push_back(next);
+			}
+		}
+	}
+
+	for (int32_t tile : region) {
+		distances[tile].store(unreachable, std::memory_order_relaxed);
+		owners[tile].store(-1, std::memory_order_relaxed);
+	}
+
+	// Flood the region again from the tiles around it, which keep their nearest source
+	size_t fromDistance = buckets.size();
+	for (int32_t tile : region) {
+		int tx = tile % width;
+		int ty = tile / width;
+
+		for (const auto& [dx, dy] : fieldDirections) {
+			int nx = tx + dx;
+			int ny = ty + dy;
+			if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+				continue;
+
+			int32_t next = static_cast<int32_t>(tileIndex(nx, ny));
+			uint16_t distance = distances[next].load(std::memory_order_relaxed);
+			if (inRegion[next] || distance == unreachable)
+				continue;
+
+			buckets[distance].push_back(next);
+			fromDistance = std::min<size_t>(fromDistance, distance);
+		}
+	}
+
+	for (int32_t tile : region)
+		inRegion[tile] = 0;
+
+	if (fromDistance < buckets.size())
+		flood(static_cast<uint16_t>(fromDistance));
+}
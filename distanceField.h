@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+// Distance from every tile to the nearest source (8-connected steps, i.e. Chebyshev distance),
+// plus which source that is. Built by a multi-source BFS and kept up to date incrementally:
+// adding a source only visits the tiles it got closer to, removing one only re-floods the
+// tiles it was nearest to from the border of that region. Ties go to the source with the lowest
+// tile index, so the field only depends on which sources exist, not on the order they came and went.
+//
+// Updates must be serialized by the caller. Reads are safe at any time - a read racing an
+// update may see a mix of old and new values, never a torn one.
+class DistanceField {
+public:
+	static constexpr uint16_t unreachable = UINT16_MAX;
+
+	DistanceField(int width, int height);
+
+	void addSource(int x, int y);
+	void removeSource(int x, int y);
+
+	// unreachable everywhere while there is no source
+	uint16_t getDistance(int x, int y) const { return distances[tileIndex(x, y)].load(std::memory_order_relaxed); }
+	std::optional<std::pair<int, int>> getNearestSource(int x, int y) const;
+
+private:
+	int width;
+	int height;
+
+	std::vector<std::atomic<uint16_t>> distances;
+	std::vector<std::atomic<int32_t>> owners; // Tile of the nearest source, -1 without one
+
+	// Writer scratch
+	std::vector<int32_t> region;
+	std::vector<uint8_t> inRegion;
+	std::vector<std::vector<int32_t>> buckets; // Tiles to expand, by distance
+
+	size_t tileIndex(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+
+	void relax(int32_t tile, uint16_t distance, int32_t owner);
+	bool isCloser(int32_t tile, uint16_t distance, int32_t owner) const; // Than the tile's current source
+	void flood(uint16_t fromDistance); // Expands the buckets in distance order
+};
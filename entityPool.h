@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <cstdint>
+#include <algorithm>
+
+#include "epochReclamation.h"
+
+// Generational reference to an entity in an EntityPool: the slot index plus the generation the slot
+// had when the entity was stored. Slots are reused, so a handle to a removed entity is caught by the
+// generation check instead of reaching whatever lives in the slot now.
+template <class T>
+struct Handle {
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	uint32_t index = invalidIndex;
+	uint32_t generation = 0;
+
+	bool isValid() const { return index != invalidIndex; }
+	friend bool operator==(const Handle&, const Handle&) = default;
+};
+
+// Registry of live entities, without ownership:
+// - sparse slots map a handle to its entity in O(1), generations catch stale handles
+// - a dense array keeps the live entities contiguous for iteration; a removal leaves a hole there
+//   until compaction rebuilds the array with only the live entries, in their original order
+//
+// Writers (insert, remove, compact) must be serialized by the caller. Readers may call get() and
+// iterate live() concurrently from inside an EpochGuard: slot pages never move, and a dense array
+// replaced by compaction is retired to the epoch manager instead of freed. Once reclaimed it is kept
+// for the next rebuild, so a pool that has settled compacts without allocating.
+template <class T>
+class EntityPool {
+private:
+	static constexpr uint32_t pageSize = 256;
+	static constexpr uint32_t maxPages = 4096; // Up to a million slots
+	static constexpr size_t minCapacity = 16;
+	static constexpr size_t maxSpareArrays = 2;
+
+	struct Slot {
+		std::atomic<T*> entity{ nullptr };
+		std::atomic<uint32_t> generation{ 0 };
+		size_t denseIndex = 0; // Writer only
+	};
+
+	struct SpareArrays;
+
+	struct DenseArray {
+		std::unique_ptr<std::atomic<T*>[]> entries;
+		size_t capacity;
+		std::atomic<size_t> size{ 0 };
+		std::shared_ptr<SpareArrays> spares; // Set while retired - the pool may be gone by the time it is reclaimed
+
+		explicit DenseArray(size_t capacity) : entries(new std::atomic<T*>[capacity]), capacity(capacity) {}
+	};
+
+	// Reclaimed arrays waiting for a rebuild - reclaim passes run on whichever thread retires
+	struct SpareArrays {
+		std::mutex mutex;
+		std::vector<DenseArray*> arrays;
+
+		SpareArrays() { arrays.reserve(maxSpareArrays); }
+		~SpareArrays() {
+			for (DenseArray* array : arrays)
+				delete array;
+		}
+	};
+
+	// Deleter for EpochManager::retire
+	static void recycle(void* object) {
+		auto* array = static_cast<DenseArray*>(object);
+		std::shared_ptr<SpareArrays> spares = std::move(array->spares);
+		{
+			std::lock_guard<std::mutex> guard(spares->mutex);
+			if (spares->arrays.size() < maxSpareArrays) {
+				spares->arrays.push_back(array);
+				return;
+			}
+		}
+		delete array;
+	}
+
+	// A reclaimed array of at least the capacity, or a new one - a pool that grew drops a spare too small
+	DenseArray* acquireArray(size_t capacity) {
+		DenseArray* tooSmall = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(spares->mutex);
+			auto fits = std::find_if(spares->arrays.begin(), spares->arrays.end(), [capacity](const DenseArray* array) {
+				return array->capacity >= capacity;
+			});
+			if (fits != spares->arrays.end()) {
+				DenseArray* array = *fits;
+				spares->arrays.erase(fits);
+				return array;
+			}
+
+			if (!spares->arrays.empty()) {
+				tooSmall = spares->arrays.back();
+				spares->arrays.pop_back();
+			}
+		}
+
+		delete tooSmall;
+		return new DenseArray(capacity);
+	}
+
+	EpochManager& epochs;
+
+	std::array<std::atomic<Slot*>, maxPages> pages{};
+	std::atomic<uint32_t> slotCount{ 0 };
+	std::vector<uint32_t> freeSlots;
+
+	std::atomic<DenseArray*> dense{ nullptr };
+	std::shared_ptr<SpareArrays> spares = std::make_shared<SpareArrays>();
+	std::vector<uint32_t> denseSlots; // Slot of each dense entry, writer only
+	size_t liveCount = 0;
+	size_t holeCount = 0;
+
+	Slot& slotAt(uint32_t index) const {
+		return pages[index / pageSize].load(std::memory_order_acquire)[index % pageSize];
+	}
+
+	// Moves the live entries into a fresh array and retires the old one
+	void rebuild(size_t capacity) {
+		DenseArray* previous = dense.load(std::memory_order_relaxed);
+		DenseArray* array = acquireArray(capacity);
+
+		size_t size = 0;
+		if (previous != nullptr) {
+			size_t previousSize = previous->size.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < previousSize; i++) {
+				T* entity = previous->entries[i].load(std::memory_order_relaxed);
+				if (entity == nullptr)
+					continue;
+
+				array->entries[size].store(entity, std::memory_order_relaxed);
+				denseSlots[size] = denseSlots[i];
+				slotAt(denseSlots[size]).denseIndex = size;
+				size++;
+			}
+		}
+
+		denseSlots.resize(size);
+		holeCount = 0;
+
+		array->size.store(size, std::memory_order_relaxed);
+		dense.store(array, std::memory_order_release);
+
+		if (previous != nullptr) {
+			previous->spares = spares;
+			epochs.retire(previous, &EntityPool::recycle);
+		}
+	}
+
+public:
+	explicit EntityPool(EpochManager& epochs) : epochs(epochs) {}
+
+	~EntityPool() {
+		for (auto& page : pages)
+			delete[] page.load();
+		delete dense.load();
+	}
+
+	EntityPool(const EntityPool&) = delete;
+	EntityPool& operator=(const EntityPool&) = delete;
+
+	Handle<T> insert(T* entity) {
+		uint32_t index;
+		if (!freeSlots.empty()) {
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			index = slotCount.load(std::memory_order_relaxed);
+			if (index % pageSize == 0)
+				pages[index / pageSize].store(new Slot[pageSize], std::memory_order_release);
+			slotCount.store(index + 1, std::memory_order_release);
+		}
+
+		DenseArray* array = dense.load(std::memory_order_relaxed);
+		if (array == nullptr || array->size.load(std::memory_order_relaxed) == array->capacity) {
+			rebuild(std::max(minCapacity, liveCount * 2 + 1));
+			array = dense.load(std::memory_order_relaxed);
+		}
+
+		size_t position = array->size.load(std::memory_order_relaxed);
+		array->entries[position].store(entity, std::memory_order_release);
+		array->size.store(position + 1, std::memory_order_release);
+		denseSlots.push_back(index);
+
+		Slot& slot = slotAt(index);
+		slot.denseIndex = position;
+		slot.entity.store(entity, std::memory_order_release);
+		liveCount++;
+
+		return { index, slot.generation.load(std::memory_order_relaxed) };
+	}
+
+	// Returns the removed entity, or nullptr for a stale handle
+	T* remove(Handle<T> handle) {
+		T* entity = get(handle);
+		if (entity == nullptr)
+			return nullptr;
+
+		Slot& slot = slotAt(handle.index);
+		dense.load(std::memory_order_relaxed)->entries[slot.denseIndex].store(nullptr, std::memory_order_release);
+		slot.entity.store(nullptr, std::memory_order_release);
+		slot.generation.store(handle.generation + 1, std::memory_order_release); // Outstanding handles go stale
+
+		freeSlots.push_back(handle.index);
+		liveCount--;
+		holeCount++;
+
+		return entity;
+	}
+
+	// O(1) - nullptr once the entity was removed, even if the slot holds a new one by now
+	T* get(Handle<T> handle) const {
+		if (handle.index >= slotCount.load(std::memory_order_acquire))
+			return nullptr;
+
+		const Slot& slot = slotAt(handle.index);
+		if (slot.generation.load(std::memory_order_acquire) != handle.generation)
+			return nullptr;
+
+		T* entity = slot.entity.load(std::memory_order_acquire);
+
+		// The slot may have been reused between the two loads
+		if (slot.generation.load(std::memory_order_acquire) != handle.generation)
+			return nullptr;
+
+		return entity;
+	}
+
+	// Live entries in insertion order - removed ones read as nullptr until the next compaction
+	std::span<const std::atomic<T*>> live() const {
+		const DenseArray* array = dense.load(std::memory_order_acquire);
+		if (array == nullptr)
+			return {};
+
+		return { array->entries.get(), array->size.load(std::memory_order_acquire) };
+	}
+
+	// Rebuilds the dense array once holes outnumber live entries, so compaction stays amortized O(1) per removal.
+	// Must not run while the calling thread iterates live() outside an EpochGuard.
+	bool compactIfFragmented() {
+		if (holeCount == 0 || holeCount < liveCount)
+			return false;
+
+		rebuild(std::max(minCapacity, liveCount * 2));
+		return true;
+	}
+
+	size_t getLiveCount() const { return liveCount; }
+	size_t getHoleCount() const { return holeCount; }
+
+	// One past the highest slot index ever handed out - the size of arrays indexed by handle index
+	size_t getSlotCount() const { return slotCount.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,138 @@
+#include "epochReclamation.h"
+
+#include <thread>
+#include <functional>
+#include <algorithm>
+
+EpochManager::~EpochManager()
+{
+	for (const auto& object : retired)
+		object.deleter(object.object);
+}
+
+// The slots the calling thread holds, one per manager it is inside a guard of
+struct HeldSlot {
+	const EpochManager* manager;
+	int slot;
+	int depth;
+};
+
+static constexpr int maxHeldSlots = 8; // Managers one thread is inside at once
+
+struct HeldSlots {
+	std::array<HeldSlot, maxHeldSlots> entries{};
+	int count = 0;
+
+	HeldSlot* find(const EpochManager* manager) {
+		for (int i = 0; i < count; i++) {
+			if (entries[i].manager == manager)
+				return &entries[i];
+		}
+		return nullptr;
+	}
+};
+
+static thread_local HeldSlots heldSlots;
+
+int EpochManager::enter()
+{
+	// Nested guard - the outer one already announced an epoch at least as old as the current one
+	if (HeldSlot* held = heldSlots.find(this)) {
+		held->depth++;
+		return held->slot;
+	}
+
+	// Start looking at a thread-specific slot so concurrent readers rarely collide
+	size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % maxReaders;
+
+	while (true) {
+		for (int i = 0; i < maxReaders; i++) {
+			int slot = static_cast<int>((start + i) % maxReaders);
+
+			// A stale announcement is safe - it only holds the epoch back
+			uint64_t expected = 0;
+			uint64_t announced = (globalEpoch.load() << 1) | 1;
+			if (slots[slot].state.compare_exchange_strong(expected, announced)) {
+				if (heldSlots.count < maxHeldSlots)
+					heldSlots.entries[heldSlots.count++] = { this, slot, 1 };
+				return slot;
+			}
+		}
+
+		std::this_thread::yield(); // Every slot is taken - this thread holds none of them
+	}
+}
+
+void EpochManager::exit(int slot)
+{
+	if (HeldSlot* held = heldSlots.find(this)) {
+		if (--held->depth > 0)
+			return;
+		*held = heldSlots.entries[--heldSlots.count];
+	}
+
+	slots[slot].state.store(0, std::memory_order_release);
+}
+
+bool EpochManager::tryAdvance()
+{
+	uint64_t epoch = globalEpoch.load();
+
+	for (const auto& slot : slots) {
+		uint64_t state = slot.state.load();
+		if ((state & 1) != 0 && (state >> 1) != epoch)
+			return false; // A reader is still in an older epoch
+	}
+
+	return globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+void EpochManager::retire(void* object, void (*deleter)(void*))
+{
+	{
+		std::lock_guard<std::mutex> guard(retiredMutex);
+		retired.push_back({ object, deleter, globalEpoch.load() });
+	}
+
+	if (retiresSinceReclaim.fetch_add(1, std::memory_order_relaxed) + 1 >= reclaimBatch)
+		tryReclaim();
+}
+
+void EpochManager::tryReclaim()
+{
+	// A pass already running frees what this one would
+	std::unique_lock<std::mutex> reclaiming(reclaimMutex, std::try_to_lock);
+	if (!reclaiming.owns_lock())
+		return;
+
+	retiresSinceReclaim.store(0, std::memory_order_relaxed);
+	tryAdvance();
+
+	uint64_t epoch = globalEpoch.load();
+	if (epoch == reclaimedEpoch)
+		return;
+	reclaimedEpoch = epoch;
+
+	{
+		std::lock_guard<std::mutex> guard(retiredMutex);
+
+		// Epochs only grow along the list, so the freeable objects are a prefix of it
+		auto stillVisible = std::partition_point(retired.begin(), retired.end(), [epoch](const RetiredObject& object) {
+			return object.epoch + 2 <= epoch;
+		});
+
+		freeable.assign(retired.begin(), stillVisible);
+		retired.erase(retired.begin(), stillVisible);
+	}
+
+	// Deleters run outside the lock
+	for (const auto& object : freeable)
+		object.deleter(object.object);
+	freeable.clear();
+}
+
+size_t EpochManager::getPendingCount()
+{
+	std::lock_guard<std::mutex> guard(retiredMutex);
+	return retired.size();
+}
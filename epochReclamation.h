@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+// Epoch-based reclamation: objects removed from shared structures are retired instead of
+// deleted, and freed only once every reader that could still hold a pointer to them has left.
+//
+// A reader announces the global epoch in a slot while it traverses shared state (EpochGuard).
+// The global epoch advances only when every active reader has announced the current one, so an
+// object retired in epoch e is unreachable to all readers once the global epoch reaches e + 2.
+//
+// Guards nest: a thread already inside a guard of the same manager reuses its slot, so a thread
+// holds at most one slot per manager and only ever waits for one while holding none.
+class EpochManager {
+public:
+	static constexpr int maxReaders = 128; // Threads inside a guard at once - a slot is held only inside a guard
+	static constexpr int reclaimBatch = 64; // Retires between two reclaim passes
+
+	EpochManager() = default;
+	~EpochManager(); // Frees everything still retired - no reader may be active
+
+	EpochManager(const EpochManager&) = delete;
+	EpochManager& operator=(const EpochManager&) = delete;
+
+	int enter();
+	void exit(int slot);
+
+	// Defers deleting an object that is no longer reachable from shared state
+	template <class T>
+	void retire(T* object) {
+		retire(object, [](void* pointer) { delete static_cast<T*>(pointer); });
+	}
+
+	void retire(void* object, void (*deleter)(void*));
+
+	// Advances the epoch if possible and frees every object no reader can observe anymore
+	void tryReclaim();
+
+	size_t getPendingCount();
+
+private:
+	// Slot state: 0 when free, otherwise (announced epoch << 1) | 1
+	struct alignas(64) ReaderSlot {
+		std::atomic<uint64_t> state{ 0 };
+	};
+
+	struct RetiredObject {
+		void* object;
+		void (*deleter)(void*);
+		uint64_t epoch;
+	};
+
+	std::array<ReaderSlot, maxReaders> slots;
+	std::atomic<uint64_t> globalEpoch{ 1 };
+
+	std::mutex retiredMutex; // Protects retired
+	std::vector<RetiredObject> retired; // In the order retired, so by epoch
+
+	std::mutex reclaimMutex; // One reclaim pass at a time - protects everything below
+	std::vector<RetiredObject> freeable; // Scratch of a reclaim pass
+	uint64_t reclaimedEpoch = 0; // Epoch of the last pass - nothing new can be freed until it advances
+	std::atomic<int> retiresSinceReclaim{ 0 };
+
+	bool tryAdvance();
+};
+
+// Marks the current scope as a reader of epoch-protected state
+class EpochGuard {
+private:
+	EpochManager& manager;
+	int slot;
+
+public:
+	explicit EpochGuard(EpochManager& manager) : manager(manager), slot(manager.enter()) {}
+	~EpochGuard() { manager.exit(slot); }
+
+	EpochGuard(const EpochGuard&) = delete;
+	EpochGuard& operator=(const EpochGuard&) = delete;
+};
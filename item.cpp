@@ -4,47 +4,98 @@
 
 bool HealthItem::use(Bot* bot)
 {
-    int previousHealth = bot->getHealth();
-    bool healed = bot->heal(30); // Heal the bot
+    StatChange healed = bot->heal(30); // Heal the bot
 
     if (healed) {
         printColoredText("HEAL", Color::Green);
-        std::cout << std::format("{} healed from {} to {} health", 
+        printLine("{} healed from {} to {} health", 
             bot->getName(), 
-            previousHealth, 
-            bot->getHealth()
-        ) << std::endl;
+            healed.previous, 
+            healed.current
+        );
         return true;
     }
     else {
         printColoredText("HEAL FAILED", Color::Red);
-        std::cout << std::format("{}: health {}", 
+        printLine("{}: health {}", 
             bot->getName(), 
             bot->getHealth()
-        ) << std::endl;
+        );
         return false;
     }
 }
 
 bool WeaponItem::use(Bot* bot)
 {
-    int previousAttackPower = bot->getAttackPower();
-    bool power = bot->increaseAttackPower(10); // Increase attack power by 10
+    StatChange power = bot->increaseAttackPower(10); // Increase attack power by 10
 
     if (power) {
         printColoredText("POWER UP", Color::Green);
-        std::cout << std::format("{} increased attack power from {} to {}", 
+        printLine("{} increased attack power from {} to {}", 
             bot->getName(), 
-            previousAttackPower, 
-            bot->getAttackPower()
-        ) << std::endl;
+            power.previous, 
+            power.current
+        );
         return true;
     }
     else {
         printColoredText("POWER UP FAILED", Color::Red);
-        std::cout << std::format("{}: attack power {}", 
+        printLine("{}: attack power {}", 
             bot->getName(), bot->getAttackPower()
-        ) << std::endl;
+        );
+        return false;
+    }
+}
+
+bool BuffItem::use(Bot* bot)
+{
+    const BuffStats& stats = getBuffStats(buff);
+    StatChange change = bot->addBuff(buff); // Expiry is scheduled by the arena
+
+    if (change) {
+        printColoredText(stats.name, Color::Green);
+        printLine("{} {} went from {} to {} for {} ticks",
+            bot->getName(),
+            stats.stat,
+            change.previous,
+            change.current,
+            stats.duration
+        );
+        return true;
+    }
+    else {
+        printColoredText("BUFF FAILED", Color::Red);
+        printLine("{}: {} is dead or holds too many", stats.name, bot->getName());
         return false;
     }
 }
+
+Item* createItem(int x, int y, ItemType type)
+{
+    switch (type) {
+        case ItemType::Health:
+            return new HealthItem(x, y);
+        case ItemType::Weapon:
+            return new WeaponItem(x, y);
+        default:
+            if (std::optional<BuffType> buff = getItemBuff(type))
+                return new BuffItem(x, y, *buff);
+            return nullptr; // Invalid item type
+    }
+}
+
+bool useItemStatic(Item& item, Bot* bot)
+{
+    switch (item.getType()) {
+        case ItemType::Health:
+            return static_cast<HealthItem&>(item).use(bot);
+        case ItemType::Weapon:
+            return static_cast<WeaponItem&>(item).use(bot);
+        case ItemType::Shield:
+        case ItemType::SpeedBoost:
+        case ItemType::AttackBuff:
+            return static_cast<BuffItem&>(item).use(bot);
+        default:
+            return false; // Invalid item type
+    }
+}
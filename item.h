@@ -1,72 +1,150 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <array>
+#include <optional>
+#include <cstdint>
 #include <iostream>
 #include <format>
 
+#include "entityPool.h"
+
 // Forward declaration of Bot class
 class Bot;
+class Item;
+
+using ItemHandle = Handle<Item>;
 
 enum class ItemType {
     Health,
 	Weapon,
+	Shield,
+	SpeedBoost,
+	AttackBuff,
     Count
-    // Future types: Shield, SpeedBoost, etc.
 };
 
+// Display data of each item type - indexed by ItemType
+constexpr std::array<std::string_view, static_cast<size_t>(ItemType::Count)> itemDescriptions = { "Health Potion", "Weapon Add-On", "Shield", "Speed Boost", "Attack Buff" };
+constexpr std::array<std::string_view, static_cast<size_t>(ItemType::Count)> itemSymbols = { "H", "W", "S", "B", "A" };
+
+// Timed effects - a buff item adds its bonus for duration ticks of the arena's buff clock.
+// Pickups of the same buff overlap, the bonus lasts until the last of them expires.
+enum class BuffType {
+	Shield,     // Defense power
+	SpeedBoost, // Speed
+	AttackBuff, // Attack power
+	Count
+};
+
+struct BuffStats {
+	std::string_view name;
+	std::string_view stat; // Stat the bonus is added to
+	ItemType item;
+	int bonus;
+	uint64_t duration;
+};
+
+// Indexed by BuffType
+constexpr std::array<BuffStats, static_cast<size_t>(BuffType::Count)> buffStats = { {
+	{ "SHIELD",      "defense power", ItemType::Shield,     10, 8 },
+	{ "SPEED BOOST", "speed",         ItemType::SpeedBoost, 1,  10 },
+	{ "ATTACK BUFF", "attack power",  ItemType::AttackBuff, 15, 8 }
+} };
+
+constexpr const BuffStats& getBuffStats(BuffType type)
+{
+	return buffStats[static_cast<size_t>(type)];
+}
+
+// Buff granted by an item type - nullopt for items with a permanent effect
+constexpr std::optional<BuffType> getItemBuff(ItemType type)
+{
+	for (size_t buff = 0; buff < buffStats.size(); buff++) {
+		if (buffStats[buff].item == type)
+			return static_cast<BuffType>(buff);
+	}
+	return std::nullopt;
+}
+
 class Item {
 private:
     int x;
     int y;
+    ItemType type;
+    ItemHandle handle; // Set when the arena stores the item
 
 public:
-    Item(int x, int y) : x(x), y(y) {}
+    Item(int x, int y, ItemType type) : x(x), y(y), type(type) {}
     virtual ~Item() = default;
 
     int getX() const { return x; }
     int getY() const { return y; }
+    ItemType getType() const { return type; }
+    ItemHandle getHandle() const { return handle; }
+
+    void setHandle(ItemHandle newHandle) { handle = newHandle; }
 
 	// Virtual methods for item behavior
-    virtual std::string getDescription() const = 0;
-	virtual std::string printType() const = 0;
-	virtual ItemType getType() const = 0;
+    virtual std::string_view getDescription() const = 0;
+	virtual std::string_view printType() const = 0;
     virtual bool use(Bot* bot) = 0;
 };
 
-class HealthItem : public Item {
+class HealthItem final : public Item {
 public:
-    HealthItem(int x, int y) : Item(x, y) {}
+    HealthItem(int x, int y) : Item(x, y, ItemType::Health) {}
 
-    std::string getDescription() const override {
-        return "Health Potion";
+    std::string_view getDescription() const override {
+        return itemDescriptions[static_cast<size_t>(ItemType::Health)];
     }
 
-    std::string printType() const override {
-        return "H";
+    std::string_view printType() const override {
+        return itemSymbols[static_cast<size_t>(ItemType::Health)];
     }
 
-	ItemType getType() const override {
-		return ItemType::Health;
-	}
-
 	bool use(Bot* bot) override;
 };
 
-class WeaponItem : public Item {
+class WeaponItem final : public Item {
 public:
-	WeaponItem(int x, int y) : Item(x, y) {}
+	WeaponItem(int x, int y) : Item(x, y, ItemType::Weapon) {}
+
+	std::string_view getDescription() const override {
+		return itemDescriptions[static_cast<size_t>(ItemType::Weapon)];
+	}
 
-	std::string getDescription() const override {
-		return "Weapon Add-On";
+	std::string_view printType() const override {
+		return itemSymbols[static_cast<size_t>(ItemType::Weapon)];
 	}
 
-	std::string printType() const override {
-		return "W";
+    bool use(Bot* bot) override;
+};
+
+// Timed items - one class for every buff, the type tag selects the buff
+class BuffItem final : public Item {
+private:
+	BuffType buff;
+
+public:
+	BuffItem(int x, int y, BuffType buff) : Item(x, y, getBuffStats(buff).item), buff(buff) {}
+
+	BuffType getBuff() const { return buff; }
+
+	std::string_view getDescription() const override {
+		return itemDescriptions[static_cast<size_t>(getType())];
 	}
 
-	ItemType getType() const override {
-		return ItemType::Weapon;
+	std::string_view printType() const override {
+		return itemSymbols[static_cast<size_t>(getType())];
 	}
 
-    bool use(Bot* bot) override;
-};
\ No newline at end of file
+	bool use(Bot* bot) override;
+};
+
+// Creates the item class of the type - nullptr for an invalid type
+Item* createItem(int x, int y, ItemType type);
+
+// Devirtualized item dispatch - the type tag selects the final class, so each use can be inlined
+bool useItemStatic(Item& item, Bot* bot);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Lock-free multi-producer, single-consumer mailbox. Producers push onto an intrusive stack with one
+// CAS, the consumer takes the whole stack with one exchange and replays it oldest first. Taking the
+// whole stack at once means no node is ever popped while another producer looks at it, so there is
+// no ABA problem and no producer ever waits for the consumer.
+//
+// Nodes are recycled through a small cache per thread. The consumer fills its cache, producers take
+// from theirs, and nodes only go back to the heap when a cache is full or its thread exits.
+//
+// The mailbox must outlive every post - with bots, the epoch guard a sender holds takes care of that.
+template <class Message>
+class Mailbox {
+private:
+	struct Node {
+		Message message;
+		Node* next = nullptr;
+	};
+
+	struct NodeCache {
+		static constexpr int capacity = 1024;
+
+		Node* first = nullptr;
+		int count = 0;
+
+		~NodeCache() {
+			while (first != nullptr)
+				delete std::exchange(first, first->next);
+		}
+	};
+
+	static NodeCache& getCache() {
+		static thread_local NodeCache cache;
+		return cache;
+	}
+
+	static Node* allocate(const Message& message) {
+		NodeCache& cache = getCache();
+		if (cache.first == nullptr)
+			return new Node{ message };
+
+		Node* node = std::exchange(cache.first, cache.first->next);
+		cache.count--;
+		node->message = message;
+		return node;
+	}
+
+	static void recycle(Node* node) {
+		NodeCache& cache = getCache();
+		if (cache.count >= NodeCache::capacity) {
+			delete node;
+			return;
+		}
+
+		node->next = std::exchange(cache.first, node);
+		cache.count++;
+	}
+
+	std::atomic<Node*> head{ nullptr }; // Newest message
+
+public:
+	Mailbox() = default;
+	~Mailbox() { // Undelivered messages are dropped
+		for (Node* node = head.load(std::memory_order_acquire); node != nullptr;)
+			delete std::exchange(node, node->next);
+	}
+
+	Mailbox(const Mailbox&) = delete;
+	Mailbox& operator=(const Mailbox&) = delete;
+
+	// Any thread
+	void post(const Message& message) {
+		Node* node = allocate(message);
+		node->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+	}
+
+	bool isEmpty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+
+	// Consumer only - hands every message posted so far to apply, in the order they were posted
+	template <class Apply>
+	int drain(Apply&& apply) {
+		Node* newest = head.exchange(nullptr, std::memory_order_acquire);
+
+		Node* oldest = nullptr;
+		while (newest != nullptr) {
+			Node* next = newest->next;
+			newest->next = oldest;
+			oldest = newest;
+			newest = next;
+		}
+
+		int count = 0;
+		while (oldest != nullptr) {
+			Node* node = std::exchange(oldest, oldest->next);
+			apply(node->message);
+			recycle(node);
+			count++;
+		}
+		return count;
+	}
+};
@@ -0,0 +1,246 @@
+#include "metrics.h"
+
+#include <fstream>
+#include <cstdio>
+#include <format>
+
+#include "utils.h"
+
+MetricsRegistry& getMetrics()
+{
+	static MetricsRegistry registry;
+	return registry;
+}
+
+std::atomic<uint64_t>* claimMetricSlot()
+{
+	return getMetrics().claimSlot();
+}
+
+GaugeRegistration::~GaugeRegistration()
+{
+	if (id != 0)
+		getMetrics().removeGauge(id);
+}
+
+GaugeRegistration& GaugeRegistration::operator=(GaugeRegistration&& other) noexcept
+{
+	if (this != &other) {
+		if (id != 0)
+			getMetrics().removeGauge(id);
+		id = std::exchange(other.id, 0);
+	}
+	return *this;
+}
+
+MetricsRegistry::MetricsRegistry()
+	: slots(std::make_unique<Slot[]>(maxMetricSlots))
+{
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(std::string_view name, std::string_view help, MetricType type)
+{
+	for (auto& family : families) {
+		if (family->name == name)
+			return *family;
+	}
+
+	families.push_back(std::make_unique<Family>(Family{ std::string(name), std::string(help), type, {}, {} }));
+	return *families.back();
+}
+
+uint32_t MetricsRegistry::reserveValues(uint32_t count)
+{
+	if (nextValue + count > maxMetricValues) {
+		printColoredText("METRICS FAILED", Color::Red);
+		printLine("All {} metric values are taken - raise maxMetricValues", maxMetricValues);
+		return 0;
+	}
+
+	uint32_t first = nextValue;
+	nextValue += count;
+	return first;
+}
+
+uint64_t MetricsRegistry::sumValue(uint32_t index) const
+{
+	uint64_t sum = 0;
+	for (int slot = 0; slot < maxMetricSlots; slot++)
+		sum += slots[slot].values[index].load(std::memory_order_relaxed);
+	return sum;
+}
+
+Counter MetricsRegistry::counter(std::string_view name, std::string_view help, std::string_view labels)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	Family& family = getFamily(name, help, MetricType::Counter);
+
+	for (const Series& series : family.series) {
+		if (series.labels == labels)
+			return Counter(series.index);
+	}
+
+	uint32_t index = reserveValues(1);
+	if (index != 0)
+		family.series.push_back({ std::string(labels), index, 0, {} });
+	return Counter(index);
+}
+
+Histogram MetricsRegistry::histogram(std::string_view name, std::string_view help, std::span<const double> bounds)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	Family& family = getFamily(name, help, MetricType::Histogram);
+
+	if (family.series.empty()) {
+		family.bounds.assign(bounds.begin(), bounds.end());
+		std::sort(family.bounds.begin(), family.bounds.end());
+
+		// A value per bucket, one for the unbounded bucket and one for the sum
+		uint32_t first = reserveValues(static_cast<uint32_t>(family.bounds.size()) + 2);
+		if (first == 0)
+			return Histogram();
+		family.series.push_back({ "", first, 0, {} });
+	}
+
+	return Histogram(family.series.front().index, family.bounds);
+}
+
+GaugeRegistration MetricsRegistry::gauge(std::string_view name, std::string_view help, std::function<double()> read, std::string_view labels)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	Family& family = getFamily(name, help, MetricType::Gauge);
+
+	uint64_t id = nextGaugeId++;
+	family.series.push_back({ std::string(labels), 0, id, std::move(read) });
+	return GaugeRegistration(id);
+}
+
+void MetricsRegistry::removeGauge(uint64_t id)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	for (auto& family : families) {
+		std::erase_if(family->series, [id](const Series& series) { return series.gaugeId == id; });
+	}
+}
+
+std::atomic<uint64_t>* MetricsRegistry::claimSlot()
+{
+	uint32_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % maxMetricSlots;
+	return slots[slot].values.data();
+}
+
+// name{labels} value, or just name value
+static std::string formatSample(std::string_view name, std::string_view labels, std::string_view value)
+{
+	if (labels.empty())
+		return std::format("{} {}\n", name, value);
+	return std::format("{}{{{}}} {}\n", name, labels, value);
+}
+
+std::string MetricsRegistry::format()
+{
+	static constexpr std::array<std::string_view, 3> typeNames = { "counter", "gauge", "histogram" };
+
+	std::lock_guard<std::mutex> guard(mutex);
+	std::string text;
+
+	for (const auto& family : families) {
+		if (family->series.empty())
+			continue;
+
+		text += std::format("# HELP {} {}\n", family->name, family->help);
+		text += std::format("# TYPE {} {}\n", family->name, typeNames[static_cast<size_t>(family->type)]);
+
+		for (const Series& series : family->series) {
+			switch (family->type) {
+				case MetricType::Counter:
+					text += formatSample(family->name, series.labels, std::to_string(sumValue(series.index)));
+					break;
+
+				case MetricType::Gauge:
+					text += formatSample(family->name, series.labels, std::format("{}", series.read()));
+					break;
+
+				case MetricType::Histogram: {
+					// Buckets are exported cumulative, the unbounded one being the count
+					uint64_t count = 0;
+					for (size_t bucket = 0; bucket <= family->bounds.size(); bucket++) {
+						count += sumValue(series.index + static_cast<uint32_t>(bucket));
+						std::string bound = bucket < family->bounds.size() ? std::format("{}", family->bounds[bucket]) : "+Inf";
+						text += formatSample(family->name + "_bucket", std::format("le=\"{}\"", bound), std::to_string(count));
+					}
+
+					auto sum = static_cast<int64_t>(sumValue(series.index + static_cast<uint32_t>(family->bounds.size()) + 1));
+					text += formatSample(family->name + "_sum", "", std::format("{}", sum / 1e9));
+					text += formatSample(family->name + "_count", "", std::to_string(count));
+					break;
+				}
+			}
+		}
+	}
+
+	return text;
+}
+
+MetricsExporter::MetricsExporter(const std::string& path, std::chrono::milliseconds interval)
+	: path(path), interval(interval)
+{
+	thread = std::thread(&MetricsExporter::exportLoop, this);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	stop();
+}
+
+bool MetricsExporter::write() const
+{
+	// rename replaces the target in one step - a reader opens either the old scrape or the new one
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream outFile(temporary, std::ios::out | std::ios::trunc);
+		if (!outFile.is_open())
+			return false;
+
+		outFile << getMetrics().format();
+		if (!outFile.good())
+			return false;
+	}
+
+	return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void MetricsExporter::exportLoop()
+{
+	bool failed = false;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!stopping) {
+		lock.unlock();
+		if (!write() && !failed) {
+			// Once is enough - a soak run should not drown its log in the same line
+			failed = true;
+			printColoredText("METRICS FAILED", Color::Red);
+			printLine("Could not write {}", path);
+		}
+		lock.lock();
+
+		wakeUp.wait_for(lock, interval, [this] { return stopping; });
+	}
+}
+
+void MetricsExporter::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		if (stopping)
+			return;
+		stopping = true;
+	}
+	wakeUp.notify_all();
+
+	if (thread.joinable())
+		thread.join();
+
+	write();
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <span>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// Live metrics of the whole process, in the Prometheus text format.
+//
+// Every thread records into a slot of its own - one relaxed fetch_add on cache lines no other thread
+// writes, so recording never contends and never takes a lock. A scrape sums a value over all slots.
+// Threads past maxMetricSlots share slots, which only costs them the contention the slots avoid.
+
+constexpr int maxMetricSlots = 128;
+constexpr int maxMetricValues = 256; // A counter takes one value, a histogram one per bucket and one for the sum
+
+class MetricsRegistry;
+MetricsRegistry& getMetrics();
+
+// The values of the calling thread's slot
+std::atomic<uint64_t>* claimMetricSlot();
+
+// Claimed on first use - a constant initializer spares every access the thread_local init wrapper
+inline std::atomic<uint64_t>* getThreadMetricValues()
+{
+	static thread_local std::atomic<uint64_t>* values = nullptr;
+	if (values == nullptr)
+		values = claimMetricSlot();
+	return values;
+}
+
+// Monotonic count - copies are cheap and all record into the same series
+class Counter {
+private:
+	uint32_t index = 0;
+
+public:
+	Counter() = default;
+	explicit Counter(uint32_t index) : index(index) {}
+
+	void increment(uint64_t amount = 1) const {
+		getThreadMetricValues()[index].fetch_add(amount, std::memory_order_relaxed);
+	}
+};
+
+// Distribution of observed values over fixed buckets, each counting the values up to its bound
+class Histogram {
+private:
+	uint32_t first = 0; // Buckets, the unbounded one, then the sum in billionths
+	std::span<const double> bounds;
+
+public:
+	Histogram() = default;
+	Histogram(uint32_t first, std::span<const double> bounds) : first(first), bounds(bounds) {}
+
+	void observe(double value) const {
+		size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+
+		std::atomic<uint64_t>* values = getThreadMetricValues();
+		values[first + bucket].fetch_add(1, std::memory_order_relaxed);
+		values[first + bounds.size() + 1].fetch_add(static_cast<uint64_t>(static_cast<int64_t>(value * 1e9)), std::memory_order_relaxed);
+	}
+};
+
+// Keeps a gauge exported until destroyed
+class GaugeRegistration {
+private:
+	uint64_t id = 0;
+
+public:
+	GaugeRegistration() = default;
+	explicit GaugeRegistration(uint64_t id) : id(id) {}
+	~GaugeRegistration();
+
+	GaugeRegistration(GaugeRegistration&& other) noexcept : id(std::exchange(other.id, 0)) {}
+	GaugeRegistration& operator=(GaugeRegistration&& other) noexcept;
+};
+
+class MetricsRegistry {
+private:
+	struct alignas(64) Slot {
+		std::array<std::atomic<uint64_t>, maxMetricValues> values{};
+	};
+
+	enum class MetricType { Counter, Gauge, Histogram };
+
+	struct Series {
+		std::string labels; // As written between the braces, e.g. reason="occupied"
+		uint32_t index = 0;
+		uint64_t gaugeId = 0;
+		std::function<double()> read; // Gauges only
+	};
+
+	struct Family {
+		std::string name;
+		std::string help;
+		MetricType type;
+		std::vector<double> bounds; // Histograms only
+		std::vector<Series> series;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<uint32_t> nextSlot{ 0 };
+
+	std::mutex mutex; // Protects everything below
+	std::vector<std::unique_ptr<Family>> families;
+	uint32_t nextValue = 1; // Value 0 takes the metrics that did not fit and is never exported
+	uint64_t nextGaugeId = 1;
+
+	Family& getFamily(std::string_view name, std::string_view help, MetricType type);
+	uint32_t reserveValues(uint32_t count);
+	uint64_t sumValue(uint32_t index) const;
+
+public:
+	MetricsRegistry();
+
+	MetricsRegistry(const MetricsRegistry&) = delete;
+	MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+	// Registering a name and labels again returns the series already there
+	Counter counter(std::string_view name, std::string_view help, std::string_view labels = {});
+	Histogram histogram(std::string_view name, std::string_view help, std::span<const double> bounds);
+
+	// read runs on the thread formatting a scrape, under the registry lock - it must not register metrics
+	GaugeRegistration gauge(std::string_view name, std::string_view help, std::function<double()> read, std::string_view labels = {});
+	void removeGauge(uint64_t id);
+
+	std::atomic<uint64_t>* claimSlot();
+
+	// Every metric with its current value, in the Prometheus text exposition format
+	std::string format();
+};
+
+// Bucket bounds of waits and turns, in seconds
+constexpr std::array<double, 8> latencyBuckets = { 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1.0, 10.0 };
+
+constexpr const char* defaultMetricsFile = "arenaMetrics.prom"; // Where Project writes its scrapes
+
+// Writes a scrape to a file every interval, for the node exporter textfile collector or a plain tail.
+// Each scrape goes to a temporary file renamed over the last one, so readers never see half of it.
+class MetricsExporter {
+private:
+	std::string path;
+	std::chrono::milliseconds interval;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	void exportLoop();
+
+public:
+	MetricsExporter(const std::string& path, std::chrono::milliseconds interval = std::chrono::seconds(1));
+	~MetricsExporter();
+
+	MetricsExporter(const MetricsExporter&) = delete;
+	MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+	// One scrape, now - false when the file cannot be written
+	bool write() const;
+
+	// Writes the last scrape and joins the thread
+	void stop();
+};
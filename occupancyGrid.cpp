@@ -0,0 +1,329 @@
+#include "occupancyGrid.h"
+#include "bot.h"
+
+#include <bit>
+#include <thread>
+#include <cstdlib>
+
+OccupancyGrid::OccupancyGrid(int width, int height)
+	: width(width), height(height)
+{
+	// One padding column on each side, plus a spare word so a window never reads past the row
+	wordsPerRow = (width + 2 + 63) / 64 + 1;
+
+	rows = std::vector<std::atomic<uint64_t>>(static_cast<size_t>(height + 2) * wordsPerRow);
+	cells = std::vector<std::atomic<Bot*>>(static_cast<size_t>(width) * height);
+	versions = std::vector<std::atomic<uint32_t>>(static_cast<size_t>(width) * height);
+}
+
+uint32_t OccupancyGrid::window(const std::atomic<uint64_t>* bits, int x)
+{
+	// Column x - 1 sits at padded bit x
+	int word = x >> 6;
+	int offset = x & 63;
+
+	uint64_t value = bits[word].load(std::memory_order_relaxed) >> offset;
+	if (offset > 61)
+		value |= bits[word + 1].load(std::memory_order_relaxed) << (64 - offset); // Window crosses into the next word
+
+	return static_cast<uint32_t>(value & 0b111);
+}
+
+void OccupancyGrid::setBit(int x, int y, const Bot* bot)
+{
+	int bit = x + 1;
+	row(y)[bit >> 6].fetch_or(uint64_t{ 1 } << (bit & 63), std::memory_order_relaxed);
+
+	if (factionCount > 0 && bot->getFaction() >= 0) {
+		factionRow(bot->getFaction(), y)[bit >> 6].fetch_or(uint64_t{ 1 } << (bit & 63), std::memory_order_relaxed);
+	}
+}
+
+void OccupancyGrid::clearBit(int x, int y, const Bot* bot)
+{
+	int bit = x + 1;
+	row(y)[bit >> 6].fetch_and(~(uint64_t{ 1 } << (bit & 63)), std::memory_order_relaxed);
+
+	if (factionCount > 0 && bot->getFaction() >= 0) {
+		factionRow(bot->getFaction(), y)[bit >> 6].fetch_and(~(uint64_t{ 1 } << (bit & 63)), std::memory_order_relaxed);
+	}
+}
+
+uint32_t OccupancyGrid::lockTile(size_t tile)
+{
+	while (true) {
+		uint32_t version = versions[tile].load(std::memory_order_relaxed);
+		if ((version & 1) == 0 && tryLockTile(tile, version))
+			return version;
+
+		std::this_thread::yield();
+	}
+}
+
+bool OccupancyGrid::tryLockTile(size_t tile, uint32_t expectedVersion)
+{
+	// An odd version is held by another writer
+	if ((expectedVersion & 1) != 0)
+		return false;
+
+	return versions[tile].compare_exchange_strong(expectedVersion, expectedVersion + 1, std::memory_order_acquire);
+}
+
+void OccupancyGrid::unlockTile(size_t tile, uint32_t newVersion)
+{
+	versions[tile].store(newVersion, std::memory_order_release);
+}
+
+void OccupancyGrid::place(Bot* bot, int x, int y)
+{
+	size_t tile = tileIndex(x, y);
+	uint32_t version = lockTile(tile);
+
+	cells[tile].store(bot, std::memory_order_release);
+	setBit(x, y, bot);
+	count.fetch_add(1, std::memory_order_relaxed);
+	if (factionCount > 0 && bot->getFaction() >= 0)
+		factionSizes[bot->getFaction()].fetch_add(1, std::memory_order_relaxed);
+
+	unlockTile(tile, version + 2);
+}
+
+void OccupancyGrid::remove(int x, int y)
+{
+	size_t tile = tileIndex(x, y);
+	uint32_t version = lockTile(tile);
+
+	Bot* bot = cells[tile].exchange(nullptr, std::memory_order_acq_rel);
+	if (bot != nullptr) {
+		clearBit(x, y, bot);
+		count.fetch_sub(1, std::memory_order_relaxed);
+		if (factionCount > 0 && bot->getFaction() >= 0)
+			factionSizes[bot->getFaction()].fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	unlockTile(tile, version + 2);
+}
+
+bool OccupancyGrid::move(int fromX, int fromY, int toX, int toY)
+{
+	// Retries the optimistic commit until it lands or the destination turns out to be taken
+	while (true) {
+		uint32_t fromVersion = getVersion(fromX, fromY);
+		uint32_t toVersion = getVersion(toX, toY);
+
+		if (get(fromX, fromY) == nullptr || isOccupied(toX, toY))
+			return false;
+
+		if (tryMove(fromX, fromY, toX, toY, fromVersion, toVersion))
+			return true;
+
+		std::this_thread::yield();
+	}
+}
+
+bool OccupancyGrid::tryMove(int fromX, int fromY, int toX, int toY, uint32_t fromVersion, uint32_t toVersion)
+{
+	size_t from = tileIndex(fromX, fromY);
+	size_t to = tileIndex(toX, toY);
+
+	if (!tryLockTile(from, fromVersion))
+		return false;
+
+	if (!tryLockTile(to, toVersion)) {
+		unlockTile(from, fromVersion); // Nothing changed - the old version stays valid
+		return false;
+	}
+
+	Bot* bot = cells[from].load(std::memory_order_relaxed);
+	if (bot == nullptr || cells[to].load(std::memory_order_relaxed) != nullptr) {
+		unlockTile(to, toVersion);
+		unlockTile(from, fromVersion);
+		return false;
+	}
+
+	// The destination is published before the source is cleared, so a reader never misses the bot
+	cells[to].store(bot, std::memory_order_release);
+	setBit(toX, toY, bot);
+
+	cells[from].store(nullptr, std::memory_order_release);
+	clearBit(fromX, fromY, bot);
+
+	unlockTile(to, toVersion + 2);
+	unlockTile(from, fromVersion + 2);
+	return true;
+}
+
+uint32_t OccupancyGrid::neighbourMask(int x, int y) const
+{
+	return neighbourMask(row(y - 1), row(y), row(y + 1), x);
+}
+
+uint32_t OccupancyGrid::neighbourMask(const std::atomic<uint64_t>* upRow, const std::atomic<uint64_t>* middleRow, const std::atomic<uint64_t>* downRow, int x) const
+{
+	uint32_t up = window(upRow, x);
+	uint32_t middle = window(middleRow, x);
+	uint32_t down = window(downRow, x);
+
+	// Bit order follows adjacentDirections
+	return (middle & 1)             // { -1, 0 }
+		| ((middle >> 2) & 1) << 1  // { 1, 0 }
+		| ((up >> 1) & 1) << 2      // { 0, -1 }
+		| ((down >> 1) & 1) << 3    // { 0, 1 }
+		| ((down >> 2) & 1) << 4    // { 1, 1 }
+		| (up & 1) << 5             // { -1, -1 }
+		| ((up >> 2) & 1) << 6      // { 1, -1 }
+		| (down & 1) << 7;          // { -1, 1 }
+}
+
+void OccupancyGrid::collectAdjacentPairs(std::vector<std::pair<Bot*, Bot*>>& pairs) const
+{
+	pairs.clear();
+
+	auto word = [this](const std::atomic<uint64_t>* bits, int w) {
+		return w >= 0 && w < wordsPerRow ? bits[w].load(std::memory_order_relaxed) : 0;
+	};
+
+	// Reports each pair from its upper-left bot: right, down, down-right and down-left neighbours
+	for (int y = 0; y < height; y++) {
+		const std::atomic<uint64_t>* current = row(y);
+		const std::atomic<uint64_t>* below = row(y + 1);
+
+		for (int w = 0; w < wordsPerRow; w++) {
+			uint64_t here = word(current, w);
+			uint64_t next = word(current, w + 1);
+			uint64_t belowHere = word(below, w);
+			uint64_t belowNext = word(below, w + 1);
+			uint64_t belowPrevious = word(below, w - 1);
+
+			uint64_t right = here & ((here >> 1) | (next << 63));
+			uint64_t down = here & belowHere;
+			uint64_t downRight = here & ((belowHere >> 1) | (belowNext << 63));
+			uint64_t downLeft = here & ((belowHere << 1) | (belowPrevious >> 63));
+
+			auto emit = [&](uint64_t mask, int dx, int dy) {
+				while (mask != 0) {
+					int x = w * 64 + std::countr_zero(mask) - 1;
+					mask &= mask - 1;
+					pairs.emplace_back(get(x, y), get(x + dx, y + dy));
+				}
+			};
+
+			emit(right, 1, 0);
+			emit(down, 0, 1);
+			emit(downRight, 1, 1);
+			emit(downLeft, -1, 1);
+		}
+	}
+}
+
+void OccupancyGrid::setFactionCount(int factions)
+{
+	factionCount = factions > 0 ? factions : 0;
+	factionRows = std::vector<std::atomic<uint64_t>>(static_cast<size_t>(factionCount) * (height + 2) * wordsPerRow);
+	factionSizes = std::vector<std::atomic<int>>(factionCount);
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			Bot* bot = get(x, y);
+			if (bot == nullptr || bot->getFaction() < 0 || bot->getFaction() >= factionCount)
+				continue;
+
+			int bit = x + 1;
+			factionRow(bot->getFaction(), y)[bit >> 6].fetch_or(uint64_t{ 1 } << (bit & 63), std::memory_order_relaxed);
+			factionSizes[bot->getFaction()].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+int OccupancyGrid::getLiveFactionCount() const
+{
+	int live = 0;
+	for (const std::atomic<int>& size : factionSizes)
+		live += size.load(std::memory_order_relaxed) > 0;
+
+	return live;
+}
+
+uint32_t OccupancyGrid::enemyNeighbourMask(int x, int y, int faction) const
+{
+	uint32_t occupied = neighbourMask(x, y);
+	if (faction < 0 || faction >= factionCount)
+		return occupied;
+
+	return occupied & ~neighbourMask(factionRow(faction, y - 1), factionRow(faction, y), factionRow(faction, y + 1), x);
+}
+
+int OccupancyGrid::nearestEnemyInRow(int faction, int y, int x, int limit, int skipX) const
+{
+	int origin = x + 1; // Padded bit of column x
+	int originWord = origin >> 6;
+	int skip = skipX + 1;
+
+	auto bits = [&](int w) {
+		uint64_t value = enemyWord(faction, y, w);
+		if (skipX >= 0 && w == (skip >> 6))
+			value &= ~(uint64_t{ 1 } << (skip & 63));
+		return value;
+	};
+
+	int right = -1;
+	for (int w = originWord; w < wordsPerRow && w * 64 - origin <= limit; w++) {
+		uint64_t value = bits(w);
+		if (w == originWord)
+			value &= ~uint64_t{ 0 } << (origin & 63);
+
+		if (value != 0) {
+			right = w * 64 + std::countr_zero(value);
+			break;
+		}
+	}
+
+	int left = -1;
+	for (int w = originWord; w >= 0 && origin - (w * 64 + 63) <= limit; w--) {
+		uint64_t value = bits(w);
+		if (w == originWord && (origin & 63) != 63)
+			value &= (uint64_t{ 2 } << (origin & 63)) - 1;
+
+		if (value != 0) {
+			left = w * 64 + 63 - std::countl_zero(value);
+			break;
+		}
+	}
+
+	int best = -1;
+	if (right >= 0 && right - origin <= limit)
+		best = right;
+	if (left >= 0 && origin - left <= limit && (best < 0 || origin - left < best - origin))
+		best = left;
+
+	return best < 0 ? -1 : best - 1;
+}
+
+std::optional<std::pair<int, int>> OccupancyGrid::findNearestEnemy(int x, int y, int faction, int radius) const
+{
+	if (faction >= factionCount)
+		faction = -1;
+
+	std::optional<std::pair<int, int>> nearest;
+	int bestDistance = INT_MAX;
+
+	// A row dy away cannot hold anything closer than dy
+	for (int dy = 0; dy < bestDistance && dy <= radius && (y - dy >= 0 || y + dy < height); dy++) {
+		const int candidateRows[2] = { y - dy, y + dy };
+		for (int i = 0; i < (dy == 0 ? 1 : 2); i++) {
+			int ny = candidateRows[i];
+			if (ny < 0 || ny >= height)
+				continue;
+
+			int limit = std::min(radius, bestDistance == INT_MAX ? width : bestDistance - dy - 1);
+			int column = nearestEnemyInRow(faction, ny, x, limit, ny == y ? x : -1);
+			if (column < 0)
+				continue;
+
+			bestDistance = dy + std::abs(column - x);
+			nearest = std::make_pair(column, ny);
+		}
+	}
+
+	return nearest;
+}
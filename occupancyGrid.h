@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <atomic>
+#include <optional>
+#include <bit>
+#include <algorithm>
+#include <climits>
+
+// Forward declaration of Bot class
+class Bot;
+
+// Bot occupancy of the arena grid: a bitboard row per y for neighbourhood queries
+// with shifts and masks, plus the bot standing on each cell for direct lookups.
+// Rows and columns carry one empty padding cell on every side, so neighbourhood
+// windows never need bounds checks.
+//
+// Every tile has a seqlock-style version counter: odd while a writer holds the tile,
+// bumped by two on each change. Writers never hold more than two tiles, for a handful
+// of atomic operations, so bitboard words and cells are atomic and readers need no lock.
+//
+// In team games every faction also has its own bitboard, kept under the same tile locks.
+// The enemies of a faction are the occupied bits minus its own, so enemy queries work on
+// whole words and never look at an ally.
+class OccupancyGrid {
+private:
+	int width;
+	int height;
+	int wordsPerRow;
+
+	std::vector<std::atomic<uint64_t>> rows; // Padded bitboard rows, wordsPerRow words each
+	std::vector<std::atomic<Bot*>> cells; // Row-major, unpadded
+	std::vector<std::atomic<uint32_t>> versions; // Row-major, unpadded
+	std::atomic<int> count{ 0 };
+
+	int factionCount = 0; // 0 in free-for-all games
+	std::vector<std::atomic<uint64_t>> factionRows; // Padded rows of faction 0, then faction 1 and so on
+	std::vector<std::atomic<int>> factionSizes;
+
+	std::atomic<uint64_t>* row(int y) { return rows.data() + static_cast<size_t>(y + 1) * wordsPerRow; }
+	const std::atomic<uint64_t>* row(int y) const { return rows.data() + static_cast<size_t>(y + 1) * wordsPerRow; }
+
+	size_t tileIndex(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+
+	std::atomic<uint64_t>* factionRow(int faction, int y) { return factionRows.data() + (static_cast<size_t>(faction) * (height + 2) + y + 1) * wordsPerRow; }
+	const std::atomic<uint64_t>* factionRow(int faction, int y) const { return factionRows.data() + (static_cast<size_t>(faction) * (height + 2) + y + 1) * wordsPerRow; }
+
+	// Occupied bits of word w of row y held by anyone but the faction - every bot for faction -1
+	uint64_t enemyWord(int faction, int y, int w) const {
+		uint64_t bits = row(y)[w].load(std::memory_order_relaxed);
+		return faction < 0 ? bits : bits & ~factionRow(faction, y)[w].load(std::memory_order_relaxed);
+	}
+
+	// Three bits of a padded row for columns x - 1, x and x + 1 (bit 0 is x - 1)
+	static uint32_t window(const std::atomic<uint64_t>* bits, int x);
+	uint32_t neighbourMask(const std::atomic<uint64_t>* up, const std::atomic<uint64_t>* middle, const std::atomic<uint64_t>* down, int x) const;
+
+	void setBit(int x, int y, const Bot* bot);
+	void clearBit(int x, int y, const Bot* bot);
+
+	// Enemy column of row y closest to x, at most limit columns away - -1 when there is none
+	int nearestEnemyInRow(int faction, int y, int x, int limit, int skipX) const;
+
+	uint32_t lockTile(size_t tile); // Spins until the tile is free, returns its even version
+	bool tryLockTile(size_t tile, uint32_t expectedVersion);
+	void unlockTile(size_t tile, uint32_t newVersion);
+
+public:
+	OccupancyGrid(int width, int height);
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getCount() const { return count.load(std::memory_order_relaxed); }
+
+	bool isInside(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+	bool isOccupied(int x, int y) const { return get(x, y) != nullptr; }
+	Bot* get(int x, int y) const { return cells[tileIndex(x, y)].load(std::memory_order_acquire); }
+	uint32_t getVersion(int x, int y) const { return versions[tileIndex(x, y)].load(std::memory_order_acquire); }
+
+	void place(Bot* bot, int x, int y);
+	void remove(int x, int y);
+	bool move(int fromX, int fromY, int toX, int toY); // False when the destination is taken
+
+	// Optimistic commit: moves the bot only if neither tile changed since the given versions were read
+	// and the destination is still empty - never waits on another writer
+	bool tryMove(int fromX, int fromY, int toX, int toY, uint32_t fromVersion, uint32_t toVersion);
+
+	// Occupied neighbours of (x, y) - bit i is set when adjacentDirections[i] holds a bot
+	uint32_t neighbourMask(int x, int y) const;
+
+	// Team games - rebuilds the faction bitboards from the bots on the grid. Only while no thread moves bots.
+	void setFactionCount(int factions);
+	int getFactionCount() const { return factionCount; }
+	int getFactionSize(int faction) const { return factionSizes[faction].load(std::memory_order_relaxed); }
+	int getLiveFactionCount() const; // Factions with at least one bot on the grid
+
+	// Neighbours of (x, y) that are not in the faction
+	uint32_t enemyNeighbourMask(int x, int y, int faction) const;
+
+	// Nearest tile (Manhattan distance) holding a bot that is not in the faction, other than (x, y) itself,
+	// within radius columns and rows of (x, y). Searches rows outwards from y and stops once no closer row
+	// is left - O(d * (d / 64 + 1)) words for an enemy d steps away, however many allies there are.
+	std::optional<std::pair<int, int>> findNearestEnemy(int x, int y, int faction, int radius = INT_MAX) const;
+
+	// Calls visit(bot) for every bot that is not in the faction inside the rectangle (bounds included,
+	// clipped to the arena) - whole words at a time, allies and tiles outside are masked out
+	template <class Visit>
+	void forEachEnemyInRect(int faction, int minX, int minY, int maxX, int maxY, Visit&& visit) const {
+		minX = std::max(minX, 0);
+		minY = std::max(minY, 0);
+		maxX = std::min(maxX, width - 1);
+		maxY = std::min(maxY, height - 1);
+		if (minX > maxX)
+			return;
+
+		int firstBit = minX + 1; // Padded bits
+		int lastBit = maxX + 1;
+
+		for (int y = minY; y <= maxY; y++) {
+			for (int w = firstBit >> 6; w <= lastBit >> 6; w++) {
+				uint64_t bits = enemyWord(faction, y, w);
+				if (w == firstBit >> 6)
+					bits &= ~uint64_t{ 0 } << (firstBit & 63);
+				if (w == lastBit >> 6)
+					bits &= ~uint64_t{ 0 } >> (63 - (lastBit & 63));
+
+				for (; bits != 0; bits &= bits - 1) {
+					Bot* bot = get(w * 64 + std::countr_zero(bits) - 1, y);
+					if (bot != nullptr) // The bot may be leaving the tile
+						visit(bot);
+				}
+			}
+		}
+	}
+
+	template <class Visit>
+	void forEachEnemy(int faction, Visit&& visit) const { forEachEnemyInRect(faction, 0, 0, width - 1, height - 1, visit); }
+
+	// Every pair of bots on adjacent tiles, each pair reported once - one pass of row shifts over the whole arena
+	void collectAdjacentPairs(std::vector<std::pair<Bot*, Bot*>>& pairs) const;
+};
@@ -0,0 +1,850 @@
+#include "partitionedArena.h"
+
+#include <deque>
+#include <new>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static constexpr int maxPartitions = 64;
+
+// Longest step of a bot, speed boost included
+static int getMaxStep()
+{
+	int speed = 0;
+	for (const ArchetypeStats& stats : archetypeStats)
+		speed = std::max(speed, statValue(speedValues, stats.speed));
+
+	return speed + getBuffStats(BuffType::SpeedBoost).bonus;
+}
+
+// Furthest an attack lands from its attacker
+static int getMaxReach()
+{
+	int reach = 0;
+	for (const AttackProfile& profile : defaultAttackProfiles)
+		reach = std::max(reach, profile.range + profile.areaRadius);
+
+	return reach;
+}
+
+int getPartitionHalo()
+{
+	int vision = 0;
+	for (const ArchetypeStats& stats : archetypeStats)
+		vision = std::max(vision, statValue(visionValues, stats.vision));
+
+	return std::max({ vision + getMaxStep(), 2 * getMaxStep(), getMaxReach() });
+}
+
+#ifdef __linux__
+
+// Fixed-size record passed between neighbouring slabs - which fields are used depends on the kind
+struct SlabMessage {
+	enum class Kind : uint8_t {
+		End,           // Last message of a halo exchange
+		ItemCollected, // x, y
+		Ghost,         // A bot of the sender within the receiver's halo
+		Migrant,       // A bot that crossed into the receiver's slab - the receiver owns it from now on
+		BuffTimer,     // Pending buff expiry of the preceding migrant: buff, dueTick
+		Move,          // A bot that moved within the receiver's halo: fromX, fromY and the bot at its destination
+		Attack         // id attacks victim for damage
+	};
+
+	Kind kind = Kind::End;
+	BotArchetype archetype = BotArchetype::Count;
+	BuffType buff = BuffType::Count;
+	int32_t id = 0;
+	int32_t x = 0;
+	int32_t y = 0;
+	int32_t fromX = 0;
+	int32_t fromY = 0;
+	int32_t faction = -1;
+	int32_t victim = -1;
+	int32_t damage = 0;
+	int32_t waypointX = -1;
+	int32_t waypointY = -1;
+	uint32_t explorations = 0;
+	uint64_t dueTick = 0;
+	CombatStats stats{};
+};
+
+// Single-producer single-consumer queue in shared memory, one per direction between two neighbours
+struct SlabRing {
+	static constexpr uint64_t capacity = 1 << 14;
+
+	alignas(64) std::atomic<uint64_t> head{ 0 }; // Next message to read
+	alignas(64) std::atomic<uint64_t> tail{ 0 }; // Next free slot
+	SlabMessage messages[capacity];
+
+	bool tryPush(const SlabMessage& message) {
+		uint64_t position = tail.load(std::memory_order_relaxed);
+		if (position - head.load(std::memory_order_acquire) == capacity)
+			return false;
+
+		messages[position % capacity] = message;
+		tail.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(SlabMessage& message) {
+		uint64_t position = head.load(std::memory_order_relaxed);
+		if (position == tail.load(std::memory_order_acquire))
+			return false;
+
+		message = messages[position % capacity];
+		head.store(position + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+// Start of the shared mapping, followed by the rings and the reduction slots
+struct PartitionHeader {
+	struct alignas(64) Progress {
+		std::atomic<uint64_t> value{ 0 }; // Phase in the high half, every lower bot id applied in the low half
+	};
+
+	alignas(64) std::atomic<uint32_t> arrived{ 0 };
+	alignas(64) std::atomic<uint32_t> generation{ 0 };
+	std::array<Progress, maxPartitions> progress;
+	LockstepResult result; // Written by partition 0
+};
+
+struct PartitionShared {
+	PartitionHeader* header;
+	SlabRing* rings; // Ring 2i carries partition i to i + 1, ring 2i + 1 partition i + 1 to i
+	uint64_t* slots; // Two rounds of partitions * valuesPerPartition values, used alternately
+	int partitions;
+	size_t valuesPerPartition;
+};
+
+static ArenaSlab getPartitionSlab(const PartitionedConfiguration& config, int partition)
+{
+	int rows = config.height / config.partitions;
+	int end = partition == config.partitions - 1 ? config.height : (partition + 1) * rows;
+	return { partition * rows, end, getPartitionHalo() };
+}
+
+// Plays one slab in a worker process - the bots of the slab are its own, the bots of the halo are ghosts
+// that only live in the occupancy grid and are rebuilt at every halo exchange
+class PartitionWorker {
+private:
+	struct Neighbour {
+		int partition;
+		ArenaSlab slab;
+		int edge; // First row of the lower of the two slabs
+		SlabRing* outgoing;
+		SlabRing* incoming;
+		std::deque<SlabMessage> inbox; // Read off the ring while waiting to send
+		std::unordered_map<int, Bot*> ghosts; // By bot id
+	};
+
+	struct PendingBuff {
+		BuffType type;
+		uint64_t dueTick;
+	};
+
+	const PartitionedConfiguration& config;
+	PartitionShared shared;
+	int index;
+	int maxStep = getMaxStep();
+	int maxReach = getMaxReach();
+
+	Arena arena;
+	std::vector<Neighbour> neighbours;
+	std::vector<Bot*> owned; // In bot id order, the order moves and attacks are applied in
+	std::unordered_map<int, std::vector<PendingBuff>> pendingBuffs; // Buff expiries a migrant takes along
+	std::vector<std::pair<int, int>> collectedItems;
+
+	uint64_t phase = 0;
+	uint64_t reductions = 0;
+
+	// Round scratch
+	std::vector<MoveIntent> intents;
+	std::vector<Bot*> targets;
+	std::vector<Bot*> areaTargets;
+	std::vector<AttackIntent> attacks;
+
+	[[noreturn]] void fail(std::string_view reason) {
+		printColoredText("PARTITIONED RUN FAILED", Color::Red);
+		std::cout << "Partition " << index << ": " << reason << std::endl;
+		_exit(1);
+	}
+
+	bool isNearEdge(const Neighbour& neighbour, int y, int rows) const { return y >= neighbour.edge - rows && y < neighbour.edge + rows; }
+
+	Bot* findOwned(int id) const {
+		auto it = std::lower_bound(owned.begin(), owned.end(), id, [](const Bot* bot, int id) { return bot->getId() < id; });
+		return it != owned.end() && (*it)->getId() == id ? *it : nullptr;
+	}
+
+	// Messaging - a blocked sender keeps reading, so two neighbours sending to each other never deadlock
+	void send(Neighbour& neighbour, const SlabMessage& message) {
+		while (!neighbour.outgoing->tryPush(message)) {
+			for (Neighbour& other : neighbours) {
+				SlabMessage incoming;
+				while (other.incoming->tryPop(incoming))
+					other.inbox.push_back(incoming);
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	const SlabMessage* peek(Neighbour& neighbour) {
+		SlabMessage incoming;
+		if (neighbour.inbox.empty() && neighbour.incoming->tryPop(incoming))
+			neighbour.inbox.push_back(incoming);
+
+		return neighbour.inbox.empty() ? nullptr : &neighbour.inbox.front();
+	}
+
+	SlabMessage receive(Neighbour& neighbour) {
+		const SlabMessage* message;
+		while ((message = peek(neighbour)) == nullptr)
+			std::this_thread::yield();
+
+		SlabMessage received = *message;
+		neighbour.inbox.pop_front();
+		return received;
+	}
+
+	static SlabMessage describe(SlabMessage::Kind kind, const Bot& bot) {
+		SlabMessage message;
+		message.kind = kind;
+		message.archetype = bot.getArchetypeType();
+		message.id = bot.getId();
+		message.x = bot.getX();
+		message.y = bot.getY();
+		message.faction = bot.getFaction();
+		message.stats = bot.getCombatStats();
+		return message;
+	}
+
+	// Sums the values over every partition - all of them get the same totals
+	std::vector<uint64_t> reduce(const std::vector<uint64_t>& values) {
+		// Alternate slots, so a fast partition writing the next round never overwrites a slot still being read
+		uint64_t* round = shared.slots + (reductions++ % 2) * shared.partitions * shared.valuesPerPartition;
+		std::copy(values.begin(), values.end(), round + index * shared.valuesPerPartition);
+
+		PartitionHeader& header = *shared.header;
+		uint32_t generation = header.generation.load(std::memory_order_acquire);
+		if (header.arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == static_cast<uint32_t>(shared.partitions)) {
+			header.arrived.store(0, std::memory_order_relaxed);
+			header.generation.fetch_add(1, std::memory_order_release);
+		}
+		else {
+			while (header.generation.load(std::memory_order_acquire) == generation)
+				std::this_thread::yield();
+		}
+
+		std::vector<uint64_t> totals(values.size(), 0);
+		for (int partition = 0; partition < shared.partitions; partition++) {
+			for (size_t i = 0; i < totals.size(); i++)
+				totals[i] += round[partition * shared.valuesPerPartition + i];
+		}
+
+		return totals;
+	}
+
+	// Move and attack phases - a partition publishes how far it got and waits for the neighbour near an edge
+	void publishProgress(uint32_t id) {
+		shared.header->progress[index].value.store(phase << 32 | id, std::memory_order_release);
+	}
+
+	// Returns once the neighbour has applied every bot below id, with its events for them applied here
+	void catchUp(Neighbour& neighbour, uint32_t id) {
+		uint64_t target = phase << 32 | id;
+		for (;;) {
+			// Everything the neighbour sent before publishing its progress is in the ring by now
+			bool caughtUp = shared.header->progress[neighbour.partition].value.load(std::memory_order_acquire) >= target;
+
+			const SlabMessage* message;
+			while ((message = peek(neighbour)) != nullptr
+				&& (message->kind == SlabMessage::Kind::Move || message->kind == SlabMessage::Kind::Attack)
+				&& static_cast<uint32_t>(message->id) < id) {
+				if (message->kind == SlabMessage::Kind::Move)
+					applyGhostMove(neighbour, *message);
+				else
+					applyRemoteAttack(*message);
+				neighbour.inbox.pop_front();
+			}
+
+			if (caughtUp)
+				return;
+			std::this_thread::yield();
+		}
+	}
+
+	void finishPhase() {
+		publishProgress(UINT32_MAX);
+		for (Neighbour& neighbour : neighbours)
+			catchUp(neighbour, UINT32_MAX);
+	}
+
+	// Ghosts
+	void placeGhost(Neighbour& neighbour, const SlabMessage& message) {
+		if (arena.bots.isOccupied(message.x, message.y))
+			fail(std::format("ghost of bot {} lands on an occupied tile", message.id));
+
+		Bot* ghost = createBot(message.archetype, message.id, message.x, message.y);
+		ghost->setFaction(message.faction); // Before placing - the grid files it under its faction
+		ghost->setCombatStats(message.stats);
+		arena.bots.place(ghost, message.x, message.y);
+		neighbour.ghosts[message.id] = ghost;
+	}
+
+	void removeGhost(Neighbour& neighbour, Bot* ghost) {
+		arena.bots.remove(ghost->getX(), ghost->getY());
+		neighbour.ghosts.erase(ghost->getId());
+		delete ghost;
+	}
+
+	void applyGhostMove(Neighbour& neighbour, const SlabMessage& message) {
+		auto it = neighbour.ghosts.find(message.id);
+		bool inHalo = arena.slab.seesRow(message.y);
+
+		if (it == neighbour.ghosts.end()) {
+			if (inHalo)
+				placeGhost(neighbour, message); // Walked into the halo
+			return;
+		}
+
+		if (!inHalo) {
+			removeGhost(neighbour, it->second);
+			return;
+		}
+
+		if (!arena.bots.move(message.fromX, message.fromY, message.x, message.y))
+			fail(std::format("move of bot {} lands on an occupied tile", message.id));
+		it->second->setPosition(message.x, message.y);
+	}
+
+	void applyRemoteAttack(const SlabMessage& message) {
+		Bot* victim = findOwned(message.victim);
+		if (victim == nullptr)
+			fail(std::format("bot {} attacks bot {}, which is not here", message.id, message.victim));
+
+		victim->takeDamage(message.damage);
+	}
+
+	// Takes in what the neighbour sent, up to its End marker
+	void receiveUntilEnd(Neighbour& neighbour) {
+		Bot* migrant = nullptr;
+		for (SlabMessage message = receive(neighbour); message.kind != SlabMessage::Kind::End; message = receive(neighbour)) {
+			switch (message.kind) {
+				case SlabMessage::Kind::ItemCollected: {
+					Item* item = arena.getItem(message.x, message.y);
+					if (item == nullptr)
+						fail(std::format("no item to collect at x: {}, y: {}", message.x, message.y));
+					arena.removeItem(item);
+					break;
+				}
+				case SlabMessage::Kind::Ghost:
+					placeGhost(neighbour, message);
+					break;
+				case SlabMessage::Kind::Migrant: {
+					auto ghost = neighbour.ghosts.find(message.id);
+					if (ghost != neighbour.ghosts.end())
+						removeGhost(neighbour, ghost->second); // Stands on the tile the bot is adopted on
+
+					migrant = createBot(message.archetype, message.id, message.x, message.y);
+					migrant->setFaction(message.faction);
+					migrant->setCombatStats(message.stats);
+					migrant->setExploration({ message.waypointX, message.waypointY }, message.explorations);
+					arena.adoptBot(migrant);
+					owned.insert(std::upper_bound(owned.begin(), owned.end(), migrant, [](const Bot* a, const Bot* b) {
+						return a->getId() < b->getId();
+					}), migrant);
+					break;
+				}
+				case SlabMessage::Kind::BuffTimer:
+					if (migrant == nullptr || migrant->getId() != message.id)
+						fail(std::format("buff timer of bot {} without the bot", message.id));
+					arena.scheduleBuffExpiry(migrant, message.buff, message.dueTick);
+					pendingBuffs[message.id].push_back({ message.buff, message.dueTick });
+					break;
+				default:
+					fail("unexpected message in a halo exchange");
+			}
+		}
+	}
+
+	// Hands over the bots that crossed an edge and passes on the items collected near an edge, then
+	// refreshes the ghosts - a second pass, so the ghosts include the bots handed over in the first
+	void exchangeHalo() {
+		TimedLockGuard guard(arena.arenaMutex);
+		uint64_t tick = arena.buffExpiries.getCurrentTick();
+
+		for (Neighbour& neighbour : neighbours) {
+			for (const auto& [x, y] : collectedItems) {
+				if (neighbour.slab.seesRow(y)) {
+					SlabMessage message;
+					message.kind = SlabMessage::Kind::ItemCollected;
+					message.x = x;
+					message.y = y;
+					send(neighbour, message);
+				}
+			}
+
+			for (Bot* bot : owned) {
+				if (!neighbour.slab.ownsRow(bot->getY()))
+					continue;
+
+				SlabMessage migrant = describe(SlabMessage::Kind::Migrant, *bot);
+				std::tie(migrant.waypointX, migrant.waypointY) = bot->getWaypoint();
+				migrant.explorations = bot->getExplorations();
+				send(neighbour, migrant);
+
+				for (const PendingBuff& buff : pendingBuffs[bot->getId()]) {
+					if (buff.dueTick <= tick)
+						continue; // Already expired
+
+					SlabMessage timer;
+					timer.kind = SlabMessage::Kind::BuffTimer;
+					timer.id = bot->getId();
+					timer.buff = buff.type;
+					timer.dueTick = buff.dueTick;
+					send(neighbour, timer);
+				}
+			}
+			send(neighbour, SlabMessage{});
+		}
+		collectedItems.clear();
+
+		std::erase_if(owned, [this](Bot* bot) {
+			if (arena.slab.ownsRow(bot->getY()))
+				return false;
+
+			pendingBuffs.erase(bot->getId());
+			arena.releaseBot(bot);
+			return true;
+		});
+
+		for (Neighbour& neighbour : neighbours)
+			receiveUntilEnd(neighbour);
+
+		for (Neighbour& neighbour : neighbours) {
+			for (Bot* bot : owned) {
+				if (neighbour.slab.seesRow(bot->getY()))
+					send(neighbour, describe(SlabMessage::Kind::Ghost, *bot));
+			}
+			send(neighbour, SlabMessage{});
+		}
+
+		for (Neighbour& neighbour : neighbours) {
+			while (!neighbour.ghosts.empty())
+				removeGhost(neighbour, neighbour.ghosts.begin()->second);
+			receiveUntilEnd(neighbour);
+		}
+	}
+
+	// Arena::checkAndCollectItem for every bot, noting what the neighbours and a later migration need to know
+	void collectItems() {
+		for (Bot* bot : owned) {
+			auto [x, y] = bot->getPosition();
+			Item* item = arena.getItem(x, y);
+			if (item == nullptr)
+				continue;
+
+			CombatStats before = bot->getCombatStats();
+			arena.checkAndCollectItem(bot->getHandle());
+			if (arena.getItem(x, y) == item)
+				continue; // Not picked up
+
+			collectedItems.push_back({ x, y });
+
+			CombatStats after = bot->getCombatStats();
+			uint64_t tick = arena.buffExpiries.getCurrentTick();
+			for (size_t type = 0; type < after.buffs.size(); type++) {
+				if (after.buffs[type] <= before.buffs[type])
+					continue;
+
+				std::vector<PendingBuff>& buffs = pendingBuffs[bot->getId()];
+				std::erase_if(buffs, [tick](const PendingBuff& buff) { return buff.dueTick <= tick; });
+				buffs.push_back({ static_cast<BuffType>(type), tick + getBuffStats(static_cast<BuffType>(type)).duration });
+			}
+		}
+	}
+
+	// Arena::applyIntents in id order - a move that ends near an edge waits for the neighbour to move
+	// every lower id first, and every move within a neighbour's halo is sent to it
+	void applyMoves() {
+		TimedLockGuard guard(arena.arenaMutex);
+		phase++;
+
+		for (Bot* bot : owned) {
+			uint32_t id = static_cast<uint32_t>(bot->getId());
+			publishProgress(id);
+
+			if (!bot->isAlive())
+				continue;
+
+			const MoveIntent& intent = intents[bot->getIdx()];
+			if (intent.action != IntentAction::Move) {
+				arena.useSkill(bot, intent);
+				continue;
+			}
+
+			auto [fromX, fromY] = bot->getPosition();
+			int toY = std::clamp(fromY + intent.direction.second, 0, arena.getHeight() - 1);
+			for (Neighbour& neighbour : neighbours) {
+				if (isNearEdge(neighbour, toY, maxStep))
+					catchUp(neighbour, id);
+			}
+
+			arena.commitMove(bot, intent.direction);
+			if (bot->getPosition() == std::make_pair(fromX, fromY))
+				continue;
+
+			for (Neighbour& neighbour : neighbours) {
+				if (!neighbour.slab.seesRow(fromY) && !neighbour.slab.seesRow(bot->getY()))
+					continue;
+
+				SlabMessage message = describe(SlabMessage::Kind::Move, *bot);
+				message.fromX = fromX;
+				message.fromY = fromY;
+				send(neighbour, message);
+			}
+		}
+
+		finishPhase();
+	}
+
+	// Arena::gatherAttackIntents and resolveAttacks in id order - an attack near an edge waits for the
+	// neighbour's lower ids, damage to the neighbour's bots is sent to it
+	void resolveCombat() {
+		TimedLockGuard guard(arena.arenaMutex);
+
+		attacks.clear();
+		areaTargets.clear();
+		for (Bot* attacker : owned) {
+			if (!attacker->isAlive())
+				continue;
+
+			targets.clear();
+			arena.findTargets(*attacker, targets);
+
+			Bot* best = nullptr;
+			for (Bot* target : targets) {
+				if (target->isAlive() && (best == nullptr
+					|| target->getHealth() < best->getHealth()
+					|| (target->getHealth() == best->getHealth() && target->getId() < best->getId())))
+					best = target;
+			}
+			if (best == nullptr)
+				continue;
+
+			AttackIntent attack{ attacker, best };
+			if (arena.getAttackProfile(attacker->getArchetypeType()).areaRadius > 0) {
+				attack.areaBegin = static_cast<uint32_t>(areaTargets.size());
+				arena.findAreaTargets(*attacker, best, areaTargets);
+				attack.areaCount = static_cast<uint32_t>(areaTargets.size()) - attack.areaBegin;
+			}
+			attacks.push_back(attack);
+		}
+
+		phase++;
+
+		for (const AttackIntent& attack : attacks) {
+			uint32_t id = static_cast<uint32_t>(attack.attacker->getId());
+			publishProgress(id);
+
+			std::span<Bot* const> hit = attack.areaCount > 0
+				? std::span<Bot* const>(areaTargets.data() + attack.areaBegin, attack.areaCount)
+				: std::span<Bot* const>(&attack.target, 1);
+
+			for (Neighbour& neighbour : neighbours) {
+				bool near = isNearEdge(neighbour, attack.attacker->getY(), maxReach);
+				for (Bot* victim : hit)
+					near = near || (arena.slab.ownsRow(victim->getY()) && isNearEdge(neighbour, victim->getY(), maxReach));
+
+				if (near)
+					catchUp(neighbour, id);
+			}
+
+			if (!attack.attacker->isAlive())
+				continue;
+
+			for (Bot* victim : hit) {
+				if (arena.slab.ownsRow(victim->getY())) {
+					AttackResult result = arena.applyAttack(attack.attacker, victim);
+					if (result.resolved)
+						arena.logAttack(attack.attacker, victim, result);
+					continue;
+				}
+
+				for (Neighbour& neighbour : neighbours) {
+					if (!neighbour.slab.ownsRow(victim->getY()))
+						continue;
+
+					SlabMessage message;
+					message.kind = SlabMessage::Kind::Attack;
+					message.id = static_cast<int32_t>(id);
+					message.victim = victim->getId();
+					message.damage = attack.attacker->getAttackPower();
+					send(neighbour, message);
+				}
+			}
+		}
+
+		finishPhase();
+
+		// Defeated bots leave at the end of the round
+		std::erase_if(owned, [this](Bot* bot) {
+			if (bot->isAlive())
+				return false;
+
+			pendingBuffs.erase(bot->getId());
+			arena.removeBot(bot);
+			return true;
+		});
+		arena.botPool.compactIfFragmented();
+	}
+
+	// Arena::playRound with two halo exchanges - before the bots decide and before they fight
+	void playRound() {
+		arena.advanceBuffClock(++arena.roundsPlayed);
+
+		collectItems();
+		exchangeHalo();
+
+		arena.decideAllMoves(intents);
+		applyMoves();
+		exchangeHalo();
+
+		resolveCombat();
+	}
+
+	// Bots, bots per archetype and bots per faction in this slab
+	std::vector<uint64_t> countBots() const {
+		std::vector<uint64_t> counts(1 + static_cast<size_t>(BotArchetype::Count) + config.factionSizes.size(), 0);
+		for (const Bot* bot : owned) {
+			counts[0]++;
+			counts[1 + static_cast<size_t>(bot->getArchetypeType())]++;
+			if (bot->getFaction() >= 0)
+				counts[1 + static_cast<size_t>(BotArchetype::Count) + bot->getFaction()]++;
+		}
+
+		return counts;
+	}
+
+public:
+	PartitionWorker(const PartitionedConfiguration& config, const PartitionShared& shared, int index)
+		: config(config), shared(shared), index(index),
+		arena(config.width, config.height, config.numberOfBots, config.numberOfItems, config.archetypeMix, config.seed,
+			getPartitionSlab(config, index))
+	{
+		arena.setVisionMode(VisionMode::Limited);
+		arena.setPathingMode(PathingMode::Greedy);
+		arena.setDispatchMode(config.dispatchMode);
+		arena.setWorkerThreads(config.workerThreads);
+		arena.setSnapshotInterval(0);
+
+		if (!config.factionSizes.empty())
+			arena.assignFactions(config.factionSizes);
+
+		for (Bot* bot : arena.botPool.live()) {
+			if (bot != nullptr)
+				owned.push_back(bot);
+		}
+		std::sort(owned.begin(), owned.end(), [](const Bot* a, const Bot* b) { return a->getId() < b->getId(); });
+
+		if (index > 0) {
+			ArenaSlab slab = getPartitionSlab(config, index - 1);
+			neighbours.push_back({ index - 1, slab, arena.slab.begin, &shared.rings[2 * (index - 1) + 1], &shared.rings[2 * (index - 1)], {}, {} });
+		}
+		if (index < config.partitions - 1) {
+			ArenaSlab slab = getPartitionSlab(config, index + 1);
+			neighbours.push_back({ index + 1, slab, slab.begin, &shared.rings[2 * index], &shared.rings[2 * index + 1], {}, {} });
+		}
+	}
+
+	~PartitionWorker() {
+		for (Neighbour& neighbour : neighbours) {
+			for (auto& [id, ghost] : neighbour.ghosts)
+				delete ghost;
+		}
+	}
+
+	PartitionWorker(const PartitionWorker&) = delete;
+	PartitionWorker& operator=(const PartitionWorker&) = delete;
+
+	// Arena::runLockstep - every partition reaches the same result
+	LockstepResult run() {
+		std::uniform_int_distribution<> distribWidth(0, config.width - 1);
+		std::uniform_int_distribution<> distribHeight(0, config.height - 1);
+		std::uniform_int_distribution<> distribItemType(0, static_cast<int>(ItemType::Count) - 1);
+
+		LockstepResult result;
+		std::vector<uint64_t> counts;
+		int liveFactions = 0;
+
+		for (;;) {
+			counts = reduce(countBots());
+
+			liveFactions = 0;
+			for (size_t faction = 0; faction < config.factionSizes.size(); faction++) {
+				if (counts[1 + static_cast<size_t>(BotArchetype::Count) + faction] > 0)
+					liveFactions++;
+			}
+
+			bool gameOver = counts[0] == 1 || (!config.factionSizes.empty() && liveFactions <= 1);
+			if (gameOver || counts[0] == 0 || (config.maxRounds > 0 && result.rounds >= config.maxRounds))
+				break;
+
+			playRound();
+
+			// Every partition draws the spawn, so they all stay on the same random sequence
+			if (++result.rounds % config.itemSpawnRounds == 0) {
+				int x = distribWidth(arena.rng);
+				int y = distribHeight(arena.rng);
+				ItemType type = static_cast<ItemType>(distribItemType(arena.rng));
+				if (arena.slab.seesRow(y))
+					arena.spawnItem(x, y, type);
+			}
+		}
+
+		uint64_t digest = 0;
+		for (const Bot* bot : owned)
+			digest += Arena::digestBot(*bot);
+		for (const Item* item : arena.itemPool.live()) {
+			if (item != nullptr && arena.slab.ownsRow(item->getY()))
+				digest += Arena::digestItem(*item);
+		}
+		result.digest = reduce({ digest })[0];
+
+		if (!config.factionSizes.empty() && liveFactions == 1 && counts[0] > 0) {
+			result.decided = true;
+			for (size_t faction = 0; faction < config.factionSizes.size(); faction++) {
+				if (counts[1 + static_cast<size_t>(BotArchetype::Count) + faction] > 0)
+					result.winningFaction = static_cast<int>(faction);
+			}
+		}
+		else if (counts[0] == 1) {
+			result.decided = true;
+			for (size_t archetype = 0; archetype < static_cast<size_t>(BotArchetype::Count); archetype++) {
+				if (counts[1 + archetype] > 0)
+					result.winner = static_cast<BotArchetype>(archetype);
+			}
+		}
+
+		return result;
+	}
+};
+
+std::optional<LockstepResult> runPartitioned(const PartitionedConfiguration& config)
+{
+	int halo = getPartitionHalo();
+
+	int factionTotal = 0;
+	bool validFactions = true;
+	for (int size : config.factionSizes) {
+		validFactions = validFactions && size > 0;
+		factionTotal += size;
+	}
+
+	bool valid = config.partitions >= 1 && config.partitions <= maxPartitions
+		&& config.width > 0 && config.height / config.partitions >= halo
+		&& config.numberOfBots <= config.width * config.height && config.itemSpawnRounds > 0
+		&& (config.factionSizes.empty() || (validFactions && factionTotal == config.numberOfBots));
+
+	if (!valid) {
+		printColoredText("PARTITIONED RUN FAILED", Color::Red);
+		printLine("Needs 1 to {} partitions of at least {} rows each, faction sizes adding up to the bots and a positive spawn interval",
+			maxPartitions, halo);
+		return std::nullopt;
+	}
+
+	// One anonymous shared mapping, created before the fork so every worker sees it at the same address
+	size_t links = static_cast<size_t>(config.partitions - 1);
+	size_t valuesPerPartition = 1 + static_cast<size_t>(BotArchetype::Count) + config.factionSizes.size();
+	size_t ringOffset = (sizeof(PartitionHeader) + alignof(SlabRing) - 1) / alignof(SlabRing) * alignof(SlabRing);
+	size_t slotOffset = ringOffset + 2 * links * sizeof(SlabRing);
+	size_t size = slotOffset + 2 * static_cast<size_t>(config.partitions) * valuesPerPartition * sizeof(uint64_t);
+
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		printColoredText("PARTITIONED RUN FAILED", Color::Red);
+		std::cout << "Could not map " << size << " bytes of shared memory" << std::endl;
+		return std::nullopt;
+	}
+
+	char* base = static_cast<char*>(memory);
+	PartitionShared shared{ new (base) PartitionHeader(), reinterpret_cast<SlabRing*>(base + ringOffset),
+		reinterpret_cast<uint64_t*>(base + slotOffset), config.partitions, valuesPerPartition };
+	for (size_t ring = 0; ring < 2 * links; ring++)
+		new (&shared.rings[ring]) SlabRing();
+
+	std::cout.flush(); // Or the workers print whatever is still buffered once more
+
+	std::vector<pid_t> workers;
+	bool failed = false;
+	for (int partition = 0; partition < config.partitions; partition++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			{
+				PartitionWorker worker(config, shared, partition);
+				LockstepResult result = worker.run();
+				if (partition == 0)
+					shared.header->result = result;
+			}
+			std::cout.flush();
+			_exit(0);
+		}
+
+		if (pid < 0) {
+			failed = true;
+			break;
+		}
+		workers.push_back(pid);
+	}
+
+	// A worker that stops leaves its neighbours waiting, so the first failure ends the others
+	size_t running = workers.size();
+	while (running > 0) {
+		if (failed) {
+			for (pid_t pid : workers)
+				kill(pid, SIGKILL);
+		}
+
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0)
+			break;
+
+		auto worker = std::find(workers.begin(), workers.end(), pid);
+		if (worker == workers.end())
+			continue;
+
+		*worker = workers.back();
+		workers.pop_back();
+		running--;
+		failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	}
+
+	LockstepResult result = shared.header->result;
+	munmap(memory, size);
+
+	if (failed) {
+		printColoredText("PARTITIONED RUN FAILED", Color::Red);
+		std::cout << "A worker process failed" << std::endl;
+		return std::nullopt;
+	}
+
+	return result;
+}
+
+#else
+
+std::optional<LockstepResult> runPartitioned(const PartitionedConfiguration& config)
+{
+	printColoredText("PARTITIONED RUN FAILED", Color::Red);
+	std::cout << "Partitioned runs fork worker processes - Linux only" << std::endl;
+	return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <thread>
+#include <cstdint>
+
+#include "arena.h"
+
+// A lockstep game split into slabs of rows, each played by its own worker process. A process owns
+// the bots of its slab and mirrors the halo rows next to it as ghost copies, so strategies and
+// attack queries run on local memory. Neighbouring slabs talk through shared-memory rings:
+// ghost refreshes twice a round, bots that cross a slab edge, and the moves and attacks that
+// land near an edge.
+//
+// Moves and attacks are applied in bot id order, as in Arena::runLockstep. A bot near an edge
+// waits until the neighbouring slab has applied every lower id, so a partitioned game plays
+// exactly like the single-process one. Strategies must only see the halo, so partitioned games
+// play with fog of war and greedy steps (VisionMode::Limited, PathingMode::Greedy).
+struct PartitionedConfiguration {
+	int width = 200;
+	int height = 200;
+	int numberOfBots = 10000;
+	int numberOfItems = 100;
+	ArchetypeMix archetypeMix = evenArchetypeMix;
+	uint32_t seed = 1;
+	std::vector<int> factionSizes; // Empty for free-for-all
+	DispatchMode dispatchMode = DispatchMode::Virtual;
+	int itemSpawnRounds = 5;
+	int maxRounds = 0; // 0 plays until the game is over
+	int partitions = 4; // Slabs of height / partitions rows, at least getPartitionHalo() each
+	int workerThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency() / 4)); // Decision threads per process
+};
+
+// Rows beyond its slab a process mirrors - as far as a bot sees, plus an item field step, and
+// twice the longest step, since two bots racing for a tile can start that far apart
+int getPartitionHalo();
+
+// Same result and digest as Arena::runLockstep on an arena built from the configuration, with
+// Limited vision and Greedy pathing. Call from a single-threaded process. nullopt when the
+// configuration cannot be split or the worker processes failed - partitioned runs need Linux.
+std::optional<LockstepResult> runPartitioned(const PartitionedConfiguration& config);
@@ -0,0 +1,155 @@
+#include "pathfinder.h"
+
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+// Straight steps first, so ties prefer them
+constexpr std::array<std::pair<int, int>, 8> pathDirections = { {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }
+} };
+
+// Search buffers reused across searches on the same thread - tiles are marked with a stamp
+// instead of clearing the arrays before every search
+struct SearchScratch {
+	std::vector<uint32_t> stamps;
+	std::vector<int> costs;
+	std::vector<int32_t> parents;
+	std::vector<std::pair<int, int32_t>> open; // (estimated total cost, tile) min-heap
+	uint32_t stamp = 0;
+
+	void prepare(size_t tiles) {
+		if (stamps.size() < tiles) {
+			stamps.assign(tiles, 0);
+			costs.resize(tiles);
+			parents.resize(tiles);
+			stamp = 0;
+		}
+
+		if (++stamp == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			stamp = 1;
+		}
+
+		open.clear();
+	}
+};
+
+static thread_local SearchScratch scratch;
+
+// A goal walled in by other bots would otherwise flood the whole reachable arena
+constexpr int maxExpandedTiles = 512;
+
+static int chebyshev(int ax, int ay, int bx, int by)
+{
+	return std::max(std::abs(ax - bx), std::abs(ay - by));
+}
+
+bool findPath(const OccupancyGrid& grid, int startX, int startY, int goalX, int goalY, int reach, PathCache& path)
+{
+	path.clear();
+	path.goalX = goalX;
+	path.goalY = goalY;
+	path.reach = reach;
+
+	if (!grid.isInside(goalX, goalY))
+		return false;
+
+	int width = grid.getWidth();
+	scratch.prepare(static_cast<size_t>(width) * grid.getHeight());
+
+	auto heuristic = [&](int x, int y) { return std::max(0, chebyshev(x, y, goalX, goalY) - reach); };
+
+	int32_t start = startY * width + startX;
+	scratch.stamps[start] = scratch.stamp;
+	scratch.costs[start] = 0;
+	scratch.parents[start] = -1;
+	scratch.open.push_back({ heuristic(startX, startY), start });
+
+	int32_t found = -1;
+	int expanded = 0;
+	while (!scratch.open.empty() && expanded < maxExpandedTiles) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<>());
+		auto [estimate, tile] = scratch.open.back();
+		scratch.open.pop_back();
+
+		int x = tile % width;
+		int y = tile / width;
+		int cost = scratch.costs[tile];
+
+		if (estimate > cost + heuristic(x, y))
+			continue; // Stale entry - the tile was reached more cheaply since
+
+		if (chebyshev(x, y, goalX, goalY) <= reach) {
+			found = tile;
+			break;
+		}
+
+		expanded++;
+
+		for (const auto& [dx, dy] : pathDirections) {
+			int nx = x + dx;
+			int ny = y + dy;
+			if (!grid.isInside(nx, ny) || grid.isOccupied(nx, ny))
+				continue;
+
+			int32_t next = ny * width + nx;
+			if (scratch.stamps[next] == scratch.stamp && scratch.costs[next] <= cost + 1)
+				continue;
+
+			scratch.stamps[next] = scratch.stamp;
+			scratch.costs[next] = cost + 1;
+			scratch.parents[next] = tile;
+			scratch.open.push_back({ cost + 1 + heuristic(nx, ny), next });
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<>());
+		}
+	}
+
+	if (found < 0)
+		return false;
+
+	for (int32_t tile = found; tile != -1; tile = scratch.parents[tile])
+		path.cells.push_back({ tile % width, tile / width });
+	std::reverse(path.cells.begin(), path.cells.end());
+
+	path.versions.reserve(path.cells.size());
+	for (const auto& [x, y] : path.cells)
+		path.versions.push_back(grid.getVersion(x, y));
+
+	return true;
+}
+
+std::optional<std::pair<int, int>> nextPathMove(const OccupancyGrid& grid, PathCache& path,
+	int x, int y, int goalX, int goalY, int reach, int speed)
+{
+	std::pair<int, int> position = { x, y };
+
+	// A moving target keeps the path as long as the path still ends within reach of it
+	bool valid = !path.cells.empty() && path.reach == reach
+		&& chebyshev(path.cells.back().first, path.cells.back().second, goalX, goalY) <= reach;
+
+	// The last move either landed on the expected cell or failed and left the bot where it was
+	if (valid) {
+		if (path.expected < path.cells.size() && path.cells[path.expected] == position)
+			path.current = path.expected;
+		else if (path.cells[path.current] != position)
+			valid = false;
+	}
+
+	// Any change on the rest of the path - a bot arriving or leaving - invalidates it
+	for (size_t i = path.current + 1; valid && i < path.cells.size(); i++) {
+		const auto& [cellX, cellY] = path.cells[i];
+		valid = grid.getVersion(cellX, cellY) == path.versions[i];
+	}
+
+	if (!valid && !findPath(grid, x, y, goalX, goalY, reach, path)) {
+		path.clear();
+		return std::nullopt;
+	}
+
+	size_t target = std::min(path.current + static_cast<size_t>(std::max(speed, 0)), path.cells.size() - 1);
+	path.expected = target;
+
+	return std::make_pair(path.cells[target].first - x, path.cells[target].second - y);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <optional>
+#include <cstdint>
+
+#include "occupancyGrid.h"
+
+// Path a bot is following, kept between turns. It stays valid until the goal moves out of reach of
+// its end, the bot leaves it, or a tile on the rest of the path changes version.
+struct PathCache {
+	int goalX = -1;
+	int goalY = -1;
+	int reach = 0;
+
+	std::vector<std::pair<int, int>> cells; // cells[0] is the tile the path was planned from
+	std::vector<uint32_t> versions; // Tile version of each cell when the path was planned
+	size_t current = 0; // Cell the bot stands on
+	size_t expected = 0; // Cell the bot stands on if its last move landed
+
+	void clear() {
+		cells.clear();
+		versions.clear();
+		current = 0;
+		expected = 0;
+	}
+};
+
+// A* over the occupancy grid - 8-connected with unit step cost, so the Chebyshev distance is an
+// exact lower bound. Occupied tiles are walls. The goal is any tile within reach (Chebyshev) of
+// (goalX, goalY). Returns false when no such tile can be reached.
+bool findPath(const OccupancyGrid& grid, int startX, int startY, int goalX, int goalY, int reach, PathCache& path);
+
+// Displacement of up to speed steps along the cached path - the path is only planned again when
+// it is no longer valid. nullopt when the goal cannot be reached.
+std::optional<std::pair<int, int>> nextPathMove(const OccupancyGrid& grid, PathCache& path,
+	int x, int y, int goalX, int goalY, int reach, int speed);
@@ -0,0 +1,318 @@
+#include "stateFeed.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "arena.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Readers in other processes see the same atomics - only lock-free ones are address-free
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free);
+
+static constexpr int readAttempts = 16;
+
+static size_t alignUp(size_t bytes, size_t alignment)
+{
+	return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static size_t getHeaderBytes()
+{
+	return alignUp(sizeof(StateFeedHeader), 64);
+}
+
+static size_t getBotsOffset(int width, int height)
+{
+	return alignUp(sizeof(FeedFrameHeader) + static_cast<size_t>(width) * height, alignof(FeedBot));
+}
+
+static size_t getFrameBytes(int width, int height, int maxBots)
+{
+	return alignUp(getBotsOffset(width, height) + static_cast<size_t>(maxBots) * sizeof(FeedBot), 64);
+}
+
+// shm_open wants a single leading slash
+static std::string getShmName(const std::string& name)
+{
+	return name.starts_with('/') ? name : "/" + name;
+}
+
+static int16_t clampStat(int value)
+{
+	return static_cast<int16_t>(std::clamp(value, static_cast<int>(INT16_MIN), static_cast<int>(INT16_MAX)));
+}
+
+uint8_t* StateFeedWriter::slot(uint32_t index) const
+{
+	return reinterpret_cast<uint8_t*>(header) + getHeaderBytes() + index * header->frameBytes;
+}
+
+StateFeedWriter::StateFeedWriter(const std::string& name, int width, int height, int maxBots)
+	: name(getShmName(name))
+{
+#ifdef __linux__
+	if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX || maxBots < 0) {
+		printColoredText("STATE FEED FAILED", Color::Red);
+		printLine("Feeds need 1 to {} rows and columns", UINT16_MAX);
+		return;
+	}
+
+	size_t frameBytes = getFrameBytes(width, height, maxBots);
+	size_t size = getHeaderBytes() + 2 * frameBytes;
+
+	// A feed left behind by a crashed run is replaced - its readers keep the old file
+	shm_unlink(this->name.c_str());
+	int descriptor = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (descriptor < 0) {
+		printColoredText("STATE FEED FAILED", Color::Red);
+		std::cout << "Could not create shared memory " << this->name << std::endl;
+		return;
+	}
+
+	void* memory = MAP_FAILED;
+	if (ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+
+	if (memory == MAP_FAILED) {
+		shm_unlink(this->name.c_str());
+		printColoredText("STATE FEED FAILED", Color::Red);
+		std::cout << "Could not map " << size << " bytes of shared memory" << std::endl;
+		return;
+	}
+
+	// The file starts zeroed - readers ignore it until the magic number is in place
+	header = new (memory) StateFeedHeader();
+	header->layout = stateFeedLayout;
+	header->width = width;
+	header->height = height;
+	header->maxBots = static_cast<uint32_t>(maxBots);
+	header->botRecordSize = sizeof(FeedBot);
+	header->frameBytes = frameBytes;
+	header->magic.store(stateFeedMagic, std::memory_order_release);
+	mappedBytes = size;
+#else
+	(void)width;
+	(void)height;
+	(void)maxBots;
+	printColoredText("STATE FEED FAILED", Color::Red);
+	std::cout << "State feeds live in POSIX shared memory - Linux only" << std::endl;
+#endif
+}
+
+StateFeedWriter::~StateFeedWriter()
+{
+#ifdef __linux__
+	if (header == nullptr)
+		return;
+
+	finish();
+	munmap(header, mappedBytes);
+	shm_unlink(name.c_str());
+#endif
+}
+
+void StateFeedWriter::publish(const ArenaSnapshot& snapshot)
+{
+	if (header == nullptr || snapshot.width != header->width || snapshot.height != header->height)
+		return;
+
+	// The slot readers were not sent to last - a reader still copying it retries on the other one
+	uint32_t index = header->latest.load(std::memory_order_relaxed) ^ 1;
+	std::atomic<uint64_t>& sequence = header->sequences[index];
+	uint64_t start = sequence.load(std::memory_order_relaxed);
+
+	sequence.store(start + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release); // The odd sequence is visible before any of the frame
+
+	uint8_t* frame = slot(index);
+	uint8_t* cells = frame + sizeof(FeedFrameHeader);
+	FeedBot* bots = reinterpret_cast<FeedBot*>(frame + getBotsOffset(header->width, header->height));
+
+	uint32_t botCount = std::min(static_cast<uint32_t>(snapshot.bots.size()), header->maxBots);
+	for (size_t tile = 0; tile < snapshot.tiles.size(); tile++) {
+		const TileSnapshot& cell = snapshot.tiles[tile];
+		if (cell.bot >= 0)
+			cells[tile] = feedBotCell + static_cast<uint8_t>(snapshot.bots[cell.bot].archetype);
+		else if (cell.item >= 0)
+			cells[tile] = feedItemCell + static_cast<uint8_t>(snapshot.items[cell.item].type);
+		else
+			cells[tile] = feedEmptyCell;
+	}
+
+	for (uint32_t i = 0; i < botCount; i++) {
+		const BotSnapshot& bot = snapshot.bots[i];
+		FeedBot& record = bots[i];
+
+		record.index = bot.index;
+		record.x = static_cast<uint16_t>(bot.x);
+		record.y = static_cast<uint16_t>(bot.y);
+		record.health = clampStat(bot.stats.health);
+		record.attackPower = clampStat(bot.stats.attackPower + bot.stats.buffBonus(BuffType::AttackBuff));
+		record.defensePower = clampStat(bot.stats.defensePower + bot.stats.buffBonus(BuffType::Shield));
+		record.faction = clampStat(bot.faction);
+		record.archetype = static_cast<uint8_t>(bot.archetype);
+		for (size_t buff = 0; buff < record.buffs.size(); buff++)
+			record.buffs[buff] = static_cast<uint8_t>(std::min(bot.stats.buffs[buff], static_cast<int>(UINT8_MAX)));
+	}
+
+	FeedFrameHeader frameHeader{ snapshot.version, botCount, static_cast<uint32_t>(snapshot.items.size()) };
+	std::memcpy(frame, &frameHeader, sizeof(frameHeader));
+
+	sequence.store(start + 2, std::memory_order_release);
+	header->latest.store(index, std::memory_order_release);
+}
+
+void StateFeedWriter::finish()
+{
+	if (header != nullptr)
+		header->finished.store(1, std::memory_order_release);
+}
+
+const uint8_t* StateFeedReader::slot(uint32_t index) const
+{
+	return reinterpret_cast<const uint8_t*>(header) + getHeaderBytes() + index * header->frameBytes;
+}
+
+StateFeedReader::StateFeedReader(const std::string& name)
+{
+#ifdef __linux__
+	int descriptor = shm_open(getShmName(name).c_str(), O_RDONLY, 0);
+	if (descriptor < 0)
+		return;
+
+	struct stat status {};
+	void* memory = MAP_FAILED;
+	if (fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) >= getHeaderBytes())
+		memory = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+
+	if (memory == MAP_FAILED)
+		return;
+
+	const auto* mapped = static_cast<const StateFeedHeader*>(memory);
+	mappedBytes = static_cast<size_t>(status.st_size);
+
+	// A feed of another layout, or one the publisher has not finished setting up
+	bool valid = mapped->magic.load(std::memory_order_acquire) == stateFeedMagic
+		&& mapped->layout == stateFeedLayout && mapped->botRecordSize == sizeof(FeedBot)
+		&& mapped->frameBytes == getFrameBytes(mapped->width, mapped->height, static_cast<int>(mapped->maxBots))
+		&& getHeaderBytes() + 2 * mapped->frameBytes <= mappedBytes;
+
+	if (!valid) {
+		munmap(memory, mappedBytes);
+		return;
+	}
+
+	header = mapped;
+#else
+	(void)name;
+#endif
+}
+
+StateFeedReader::~StateFeedReader()
+{
+#ifdef __linux__
+	if (header != nullptr)
+		munmap(const_cast<StateFeedHeader*>(header), mappedBytes);
+#endif
+}
+
+bool StateFeedReader::read(FeedFrame& frame) const
+{
+	if (header == nullptr)
+		return false;
+
+	size_t tileCount = static_cast<size_t>(header->width) * header->height;
+	frame.width = header->width;
+	frame.height = header->height;
+	frame.cells.resize(tileCount);
+
+	for (int attempt = 0; attempt < readAttempts; attempt++) {
+		uint32_t index = header->latest.load(std::memory_order_acquire);
+		const std::atomic<uint64_t>& sequence = header->sequences[index];
+
+		uint64_t start = sequence.load(std::memory_order_acquire);
+		if (start == 0)
+			return false; // Nothing published yet
+		if (start % 2 != 0)
+			continue;
+
+		// The copy may be torn by the publisher lapping us - the sequence check below throws it away
+		const uint8_t* source = slot(index);
+		FeedFrameHeader frameHeader;
+		std::memcpy(&frameHeader, source, sizeof(frameHeader));
+		uint32_t botCount = std::min(frameHeader.botCount, header->maxBots);
+
+		std::memcpy(frame.cells.data(), source + sizeof(FeedFrameHeader), tileCount);
+		frame.bots.resize(botCount);
+		std::memcpy(frame.bots.data(), source + getBotsOffset(header->width, header->height), botCount * sizeof(FeedBot));
+
+		std::atomic_thread_fence(std::memory_order_acquire); // The copy is done before the sequence is read again
+		if (sequence.load(std::memory_order_relaxed) != start)
+			continue;
+
+		frame.version = frameHeader.version;
+		frame.itemCount = frameHeader.itemCount;
+		return true;
+	}
+
+	return false;
+}
+
+StateFeedPublisher::StateFeedPublisher(const Arena& arena, const std::string& name, std::chrono::milliseconds interval)
+	: arena(arena), writer(name, arena.getWidth(), arena.getHeight(), arena.getNumOfBots()), interval(interval)
+{
+	if (writer.isOpen())
+		thread = std::thread(&StateFeedPublisher::publishLoop, this);
+}
+
+StateFeedPublisher::~StateFeedPublisher()
+{
+	stop();
+}
+
+void StateFeedPublisher::publishLoop()
+{
+	uint64_t publishedVersion = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!stopping) {
+		lock.unlock();
+		{
+			SnapshotView snapshot = arena.getSnapshot();
+			if (snapshot->version != publishedVersion) {
+				writer.publish(*snapshot);
+				publishedVersion = snapshot->version;
+			}
+		}
+		lock.lock();
+
+		wakeUp.wait_for(lock, interval, [this] { return stopping; });
+	}
+}
+
+void StateFeedPublisher::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		if (stopping)
+			return;
+		stopping = true;
+	}
+	wakeUp.notify_all();
+
+	if (!thread.joinable())
+		return;
+	thread.join();
+
+	writer.publish(*arena.getSnapshot());
+	writer.finish();
+}
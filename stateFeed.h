@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+#include "arenaSnapshot.h"
+
+class Arena;
+
+// Frames of the arena in a shared memory file (/dev/shm/<name> on Linux) for viewers and analytics in
+// other processes. Two frame slots, each behind a seqlock: the publisher always writes the slot readers
+// were not sent to last, and readers copy a frame and retry if its sequence changed meanwhile. Readers
+// map the file read-only, so any number of them can attach and none can hold up the publisher.
+
+constexpr uint32_t stateFeedMagic = 0x46415242; // "BRAF"
+constexpr uint32_t stateFeedLayout = 1; // Bumped whenever the layout below changes
+constexpr const char* defaultStateFeed = "arenaFeed"; // Name Project publishes under and Viewer attaches to
+
+// Cell codes of the frame's cell array
+constexpr uint8_t feedEmptyCell = 0;
+constexpr uint8_t feedBotCell = 1; // feedBotCell + BotArchetype
+constexpr uint8_t feedItemCell = 16; // feedItemCell + ItemType, when no bot stands on the item
+
+struct FeedBot {
+	int32_t index;
+	uint16_t x;
+	uint16_t y;
+	int16_t health;
+	int16_t attackPower; // Buffs included
+	int16_t defensePower; // Buffs included
+	int16_t faction; // -1 in free-for-all games
+	uint8_t archetype; // BotArchetype
+	std::array<uint8_t, static_cast<size_t>(BuffType::Count)> buffs;
+};
+
+// Start of the shared file, followed by two slots of frameBytes each
+struct StateFeedHeader {
+	std::atomic<uint32_t> magic; // Stored last, once the rest of the header is set
+	uint32_t layout;
+	int32_t width;
+	int32_t height;
+	uint32_t maxBots; // Bots past this many are left out of a frame
+	uint32_t botRecordSize; // sizeof(FeedBot), checked by readers
+	uint64_t frameBytes;
+	std::atomic<uint32_t> latest; // Slot of the newest complete frame
+	std::atomic<uint32_t> finished; // Set once the game is over - the last frame stays
+	std::array<std::atomic<uint64_t>, 2> sequences; // Odd while the slot is being written
+};
+
+// A slot holds this header, then width * height cell codes, then maxBots FeedBot records
+struct FeedFrameHeader {
+	uint64_t version; // Snapshot version
+	uint32_t botCount;
+	uint32_t itemCount;
+};
+
+// Frame as copied out by a reader
+struct FeedFrame {
+	uint64_t version = 0;
+	int width = 0;
+	int height = 0;
+	uint32_t itemCount = 0;
+	std::vector<uint8_t> cells; // Row-major cell codes
+	std::vector<FeedBot> bots;
+
+	uint8_t cell(int x, int y) const { return cells[static_cast<size_t>(y) * width + x]; }
+};
+
+// Creates the shared file and writes frames into it - a single writer. Writing never waits for readers.
+class StateFeedWriter {
+private:
+	std::string name;
+	StateFeedHeader* header = nullptr;
+	size_t mappedBytes = 0;
+
+	uint8_t* slot(uint32_t index) const;
+
+public:
+	// Failures are reported and leave the writer closed - publishing then does nothing
+	StateFeedWriter(const std::string& name, int width, int height, int maxBots);
+	~StateFeedWriter(); // Removes the file - attached readers keep their mapping
+
+	StateFeedWriter(const StateFeedWriter&) = delete;
+	StateFeedWriter& operator=(const StateFeedWriter&) = delete;
+
+	bool isOpen() const { return header != nullptr; }
+	void publish(const ArenaSnapshot& snapshot);
+	void finish();
+};
+
+// Attaches to a feed published by another process
+class StateFeedReader {
+private:
+	const StateFeedHeader* header = nullptr;
+	size_t mappedBytes = 0;
+
+	const uint8_t* slot(uint32_t index) const;
+
+public:
+	explicit StateFeedReader(const std::string& name); // Closed when there is no such feed
+	~StateFeedReader();
+
+	StateFeedReader(const StateFeedReader&) = delete;
+	StateFeedReader& operator=(const StateFeedReader&) = delete;
+
+	bool isOpen() const { return header != nullptr; }
+	bool isFinished() const { return header->finished.load(std::memory_order_acquire) != 0; }
+
+	// Copies the newest complete frame - false when none was published yet, or the publisher
+	// lapped every attempt (it writes faster than the reader copies)
+	bool read(FeedFrame& frame) const;
+};
+
+// Publishes the arena's snapshots to a state feed from a background thread, at most once per interval.
+// It only reads published snapshots, so the simulation never waits for it.
+class StateFeedPublisher {
+private:
+	const Arena& arena;
+	StateFeedWriter writer;
+	std::chrono::milliseconds interval;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	void publishLoop();
+
+public:
+	StateFeedPublisher(const Arena& arena, const std::string& name, std::chrono::milliseconds interval = std::chrono::milliseconds(50));
+	~StateFeedPublisher();
+
+	StateFeedPublisher(const StateFeedPublisher&) = delete;
+	StateFeedPublisher& operator=(const StateFeedPublisher&) = delete;
+
+	bool isOpen() const { return writer.isOpen(); }
+
+	// Publishes the last snapshot, marks the feed finished and joins the thread
+	void stop();
+};
@@ -0,0 +1,91 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+#include "cpuAffinity.h"
+
+ThreadPool::ThreadPool(int numThreads, const std::vector<int>& cpus)
+{
+	for (int i = 1; i < numThreads; i++) {
+		int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+		workers.emplace_back(&ThreadPool::workerLoop, this, cpu);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::runChunks()
+{
+	while (true) {
+		size_t begin = nextIndex.fetch_add(chunkSize, std::memory_order_relaxed);
+		if (begin >= jobSize)
+			return;
+
+		job(begin, std::min(begin + chunkSize, jobSize));
+	}
+}
+
+void ThreadPool::workerLoop(int cpu)
+{
+	if (cpu >= 0)
+		pinCurrentThread(cpu);
+
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+
+			if (stopping)
+				return;
+
+			seenGeneration = generation;
+		}
+
+		runChunks();
+
+		std::lock_guard<std::mutex> guard(mutex);
+		if (--busyWorkers == 0)
+			workDone.notify_one();
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& body)
+{
+	if (count == 0)
+		return;
+
+	// Small jobs are not worth waking the workers for
+	if (workers.empty() || count == 1) {
+		body(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		job = body;
+		jobSize = count;
+		chunkSize = std::max<size_t>(1, count / (static_cast<size_t>(getNumThreads()) * 4));
+		nextIndex.store(0, std::memory_order_relaxed);
+		busyWorkers = workers.size();
+		generation++;
+	}
+	workAvailable.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	workDone.wait(lock, [&] { return busyWorkers == 0; });
+	job = nullptr;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+// Fixed set of worker threads for data-parallel phases of the simulation.
+// The calling thread takes part in every job, so a pool of N threads starts N - 1 workers.
+// With a CPU list, worker i is pinned to cpus[i % cpus.size()] - cpus[0] is left to the caller.
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workDone;
+
+	// Current job - published under mutex, indices are claimed in chunks without it
+	std::function<void(size_t, size_t)> job;
+	size_t jobSize = 0;
+	size_t chunkSize = 1;
+	std::atomic<size_t> nextIndex{ 0 };
+	size_t busyWorkers = 0;
+	uint64_t generation = 0;
+	bool stopping = false;
+
+	void workerLoop(int cpu);
+	void runChunks();
+
+public:
+	explicit ThreadPool(int numThreads, const std::vector<int>& cpus = {});
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int getNumThreads() const { return static_cast<int>(workers.size()) + 1; }
+
+	// Calls body(begin, end) over disjoint ranges covering [0, count) and returns once all of them finished
+	void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body);
+};
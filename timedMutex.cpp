@@ -1,28 +1,110 @@
 #include "timedMutex.h"
 
-void TimedMutex::lock() 
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Tells the CPU we are spinning - frees pipeline resources for the other hyperthread
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#endif
+}
+
+void SpinParkLock::lock()
+{
+    int limit = spinLimit.load(std::memory_order_relaxed);
+
+    for (int spins = 0; spins < limit; spins++) {
+        int expected = 0;
+        if (state.load(std::memory_order_relaxed) == 0
+            && state.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            // Acquired while spinning - move the limit towards twice what it took
+            spinLimit.store(std::clamp(limit + (2 * spins - limit) / 8, minSpins, maxSpins), std::memory_order_relaxed);
+            return;
+        }
+
+        cpuRelax();
+    }
+
+    // Spinning did not pay off this time - spin less next time
+    spinLimit.store(std::max(minSpins, limit - limit / 8), std::memory_order_relaxed);
+
+    // Mark the lock as contended, so the holder wakes us when it releases
+    int current = state.exchange(2, std::memory_order_acquire);
+    while (current != 0) {
+        state.wait(2, std::memory_order_relaxed);
+        current = state.exchange(2, std::memory_order_acquire);
+    }
+}
+
+void SpinParkLock::unlock()
+{
+    if (state.exchange(0, std::memory_order_release) == 2)
+        state.notify_one();
+}
+
+void TicketLock::lock()
 {
-    auto start = std::chrono::high_resolution_clock::now();
-    internalMutex.lock();
-    auto end = std::chrono::high_resolution_clock::now();
+    uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+
+    for (int spins = 0; spins < spinsBeforePark; spins++) {
+        if (nowServing.load(std::memory_order_acquire) == ticket)
+            return;
+
+        cpuRelax();
+    }
 
-    auto waitTime = end - start;
+    // Read the slot before checking the ticket - an unlock in between changes the slot, so the wait returns
+    std::atomic<uint32_t>& slot = slots[ticket % parkSlots].served;
+    while (true) {
+        uint32_t served = slot.load(std::memory_order_acquire);
+        if (nowServing.load(std::memory_order_acquire) == ticket)
+            return;
 
-    std::lock_guard<std::mutex> guard(statsMutex);
-    threadWaitMap[std::this_thread::get_id()] += waitTime;
+        slot.wait(served, std::memory_order_relaxed);
+    }
 }
 
-std::chrono::duration<double> TimedMutex::getThreadWaitTime(std::thread::id id) 
+void TicketLock::unlock()
 {
-    std::lock_guard<std::mutex> guard(statsMutex);
-    return threadWaitMap[id];
+    uint32_t next = nowServing.fetch_add(1, std::memory_order_release) + 1;
+
+    // Only tickets a multiple of parkSlots apart wait on this slot - usually just the next one
+    std::atomic<uint32_t>& slot = slots[next % parkSlots].served;
+    slot.store(next, std::memory_order_release);
+    slot.notify_all();
 }
 
-std::chrono::duration<double> TimedMutex::getTotalWaitTime() 
+void SelectableLock::lock()
 {
-    std::lock_guard<std::mutex> guard(statsMutex);
-    std::chrono::duration<double> sum{ 0 };
-    for (const auto& [_, dur] : threadWaitMap)
-        sum += dur;
-    return sum;
-}
\ No newline at end of file
+    switch (policy) {
+        case LockPolicy::SpinThenPark:
+            spinParkLock.lock();
+            break;
+        case LockPolicy::Ticket:
+            ticketLock.lock();
+            break;
+        default:
+            stdLock.lock();
+            break;
+    }
+}
+
+void SelectableLock::unlock()
+{
+    switch (policy) {
+        case LockPolicy::SpinThenPark:
+            spinParkLock.unlock();
+            break;
+        case LockPolicy::Ticket:
+            ticketLock.unlock();
+            break;
+        default:
+            stdLock.unlock();
+            break;
+    }
+}
@@ -1,34 +1,168 @@
 #pragma once
 #include <mutex>
+#include <atomic>
+#include <array>
+#include <thread>
 #include <chrono>
+#include <cstdint>
 #include <unordered_map>
 
-class TimedMutex {
+#include "metrics.h"
+
+// How a TimedMutex waits for the lock
+enum class LockPolicy {
+    Std,          // std::mutex
+    SpinThenPark, // Spins for an adaptive number of iterations, then sleeps until woken
+    Ticket        // FIFO - threads get the lock in the order they asked for it
+};
+
+class StdLock {
 private:
     std::mutex internalMutex;
-    std::chrono::duration<double> totalWaitTime{ 0 };
+
+public:
+    void lock() { internalMutex.lock(); }
+    void unlock() { internalMutex.unlock(); }
+};
+
+// Spins while the holder is likely to release soon, parks on the lock word otherwise.
+// The spin limit follows how long acquisitions actually took, so a lock that is held
+// for long stops burning CPU and a lock held briefly never parks.
+class SpinParkLock {
+private:
+    static constexpr int minSpins = 16;
+    static constexpr int maxSpins = 4096;
+
+    std::atomic<int> state{ 0 }; // 0 unlocked, 1 locked, 2 locked with parked waiters
+    std::atomic<int> spinLimit{ 256 };
+
+public:
+    void lock();
+    void unlock();
+};
+
+// Ticket lock - a waiter takes the next ticket and waits until it is served, so nobody is
+// overtaken. Waiters spin briefly, then park on the slot of their own ticket, so a release
+// wakes only the next waiter - not every parked one, which would just park again.
+class TicketLock {
+private:
+    static constexpr int spinsBeforePark = 128;
+    static constexpr uint32_t parkSlots = 64; // Tickets this far apart share a slot
+
+    // Last ticket served through the slot
+    struct alignas(64) ParkSlot {
+        std::atomic<uint32_t> served{ 0 };
+    };
+
+    alignas(64) std::atomic<uint32_t> nextTicket{ 0 };
+    alignas(64) std::atomic<uint32_t> nowServing{ 0 };
+    std::array<ParkSlot, parkSlots> slots{};
+
+public:
+    void lock();
+    void unlock();
+};
+
+// Lock whose policy is picked at run time, so one arena can run with any of them.
+// Change the policy only while nobody holds or waits for the lock.
+class SelectableLock {
+private:
+    LockPolicy policy = LockPolicy::Std;
+    StdLock stdLock;
+    SpinParkLock spinParkLock;
+    TicketLock ticketLock;
+
+public:
+    void setPolicy(LockPolicy newPolicy) { policy = newPolicy; }
+    LockPolicy getPolicy() const { return policy; }
+
+    void lock();
+    void unlock();
+};
+
+// Locks the calling thread took through any TimedMutex, and how long it waited for them. Only the
+// thread itself touches its counters - read them before and after some work to charge its locking to it.
+struct LockUsage {
+    uint64_t acquisitions = 0;
+    std::chrono::duration<double> waitTime{ 0 };
+};
+
+inline LockUsage& getThreadLockUsage()
+{
+    static thread_local LockUsage usage;
+    return usage;
+}
+
+// Lock with per-thread wait time tracking - Lock is any of the policies above
+template <class Lock>
+class BasicTimedMutex {
+private:
+    Lock internalMutex;
 
 public:
     // For per-thread tracking
     std::unordered_map<std::thread::id, std::chrono::duration<double>> threadWaitMap;
     std::mutex statsMutex; // protects threadWaitMap
 
-    void lock();
+    void lock()
+    {
+        // Registered on the first lock, before this thread holds any
+        static const Counter acquisitionsMetric = getMetrics().counter("arena_lock_acquisitions_total", "Locks taken through a TimedMutex");
+        static const Histogram waitMetric = getMetrics().histogram("arena_lock_wait_seconds", "Time spent waiting for a TimedMutex", latencyBuckets);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        internalMutex.lock();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        auto waitTime = end - start;
+
+        LockUsage& usage = getThreadLockUsage();
+        usage.acquisitions++;
+        usage.waitTime += waitTime;
+
+        acquisitionsMetric.increment();
+        waitMetric.observe(std::chrono::duration<double>(waitTime).count());
+
+        std::lock_guard<std::mutex> guard(statsMutex);
+        threadWaitMap[std::this_thread::get_id()] += waitTime;
+    }
 
     void unlock() 
     {
         internalMutex.unlock();
     }
 
-    std::chrono::duration<double> getThreadWaitTime(std::thread::id id);
+    Lock& getLock() { return internalMutex; }
+
+    std::chrono::duration<double> getThreadWaitTime(std::thread::id id)
+    {
+        std::lock_guard<std::mutex> guard(statsMutex);
+        return threadWaitMap[id];
+    }
+
+    std::chrono::duration<double> getTotalWaitTime()
+    {
+        std::lock_guard<std::mutex> guard(statsMutex);
+        std::chrono::duration<double> sum{ 0 };
+        for (const auto& [_, dur] : threadWaitMap)
+            sum += dur;
+        return sum;
+    }
 
-    std::chrono::duration<double> getTotalWaitTime();
+    void resetWaitTimes()
+    {
+        std::lock_guard<std::mutex> guard(statsMutex);
+        threadWaitMap.clear();
+    }
 };
 
+using TimedMutex = BasicTimedMutex<SelectableLock>;
+
+template <class Mutex>
 class TimedLockGuard {
 private:
-    TimedMutex& tm;
+    Mutex& tm;
 public:
-    TimedLockGuard(TimedMutex& tm) : tm(tm) { tm.lock(); }
+    TimedLockGuard(Mutex& tm) : tm(tm) { tm.lock(); }
     ~TimedLockGuard() { tm.unlock(); }
-};
\ No newline at end of file
+};
@@ -0,0 +1,240 @@
+#include "timingWheel.h"
+
+#include <algorithm>
+
+TimingWheel::TimingWheel()
+{
+	slots.fill(-1);
+}
+
+void TimingWheel::link(int32_t index)
+{
+	Node& node = nodes[index];
+
+	// The coarsest level whose slot still separates the timer from now
+	uint64_t due = std::min(node.dueTick, currentTick + maxDelay);
+	uint64_t delta = due - currentTick;
+
+	int level = 0;
+	while (level < levels - 1 && delta >= (uint64_t{ 1 } << (levelBits * (level + 1))))
+		level++;
+
+	int32_t slot = level * slotsPerLevel + static_cast<int32_t>((due >> (levelBits * level)) & (slotsPerLevel - 1));
+
+	node.slot = slot;
+	node.previous = -1;
+	node.next = slots[slot];
+	if (node.next != -1)
+		nodes[node.next].previous = index;
+	slots[slot] = index;
+}
+
+void TimingWheel::unlink(int32_t index)
+{
+	Node& node = nodes[index];
+
+	if (node.previous != -1)
+		nodes[node.previous].next = node.next;
+	else
+		slots[node.slot] = node.next;
+
+	if (node.next != -1)
+		nodes[node.next].previous = node.previous;
+}
+
+void TimingWheel::release(int32_t index)
+{
+	Node& node = nodes[index];
+
+	node.slot = -1;
+	node.task = nullptr;
+	node.generation++; // Outstanding handles to this timer go stale
+	node.next = freeList;
+	freeList = index;
+
+	pendingCount--;
+}
+
+void TimingWheel::cascade(int level)
+{
+	int32_t slot = level * slotsPerLevel + static_cast<int32_t>((currentTick >> (levelBits * level)) & (slotsPerLevel - 1));
+
+	// Every timer in the slot is now close enough for a finer level
+	int32_t index = slots[slot];
+	slots[slot] = -1;
+
+	while (index != -1) {
+		int32_t next = nodes[index].next;
+		link(index);
+		index = next;
+	}
+}
+
+TimerHandle TimingWheel::schedule(uint64_t dueTick, TimerTask task)
+{
+	int32_t index = freeList;
+	if (index != -1) {
+		freeList = nodes[index].next;
+	}
+	else {
+		index = static_cast<int32_t>(nodes.size());
+		nodes.emplace_back();
+	}
+
+	Node& node = nodes[index];
+	node.dueTick = std::max(dueTick, currentTick + 1); // The current tick has already been processed
+	node.task = std::move(task);
+
+	link(index);
+	pendingCount++;
+
+	return { static_cast<uint32_t>(index), node.generation };
+}
+
+bool TimingWheel::cancel(TimerHandle handle)
+{
+	if (handle.index >= nodes.size())
+		return false;
+
+	int32_t index = static_cast<int32_t>(handle.index);
+	Node& node = nodes[index];
+	if (node.generation != handle.generation || node.slot == -1)
+		return false;
+
+	unlink(index);
+	release(index);
+	return true;
+}
+
+void TimingWheel::advance(uint64_t toTick, std::vector<TimerTask>& expired)
+{
+	while (currentTick < toTick) {
+		// Nothing to cascade or expire on the way
+		if (pendingCount == 0) {
+			currentTick = toTick;
+			return;
+		}
+
+		currentTick++;
+
+		// Coarse levels first - a timer cascaded from level 2 may go on to level 1 and expire this tick
+		for (int level = levels - 1; level > 0; level--) {
+			if ((currentTick & ((uint64_t{ 1 } << (levelBits * level)) - 1)) == 0)
+				cascade(level);
+		}
+
+		int32_t slot = static_cast<int32_t>(currentTick & (slotsPerLevel - 1));
+		int32_t index = slots[slot];
+		slots[slot] = -1;
+
+		while (index != -1) {
+			Node& node = nodes[index];
+			int32_t next = node.next;
+
+			// Beyond the range of the wheel when scheduled - goes round again
+			if (node.dueTick > currentTick) {
+				link(index);
+			}
+			else {
+				expired.push_back(std::move(node.task));
+				release(index);
+			}
+
+			index = next;
+		}
+	}
+}
+
+Scheduler::Scheduler(int numThreads, std::chrono::milliseconds tick)
+	: tick(std::max(tick, std::chrono::milliseconds(1))), start(Clock::now())
+{
+	for (int i = 0; i < std::max(1, numThreads); i++)
+		drivers.emplace_back(&Scheduler::driverLoop, this);
+}
+
+Scheduler::~Scheduler()
+{
+	stop();
+}
+
+void Scheduler::driverLoop()
+{
+	std::vector<TimerTask> expired;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!stopping) {
+		// Whichever driver is free moves the wheel to the current time
+		wheel.advance(tickNow(), expired);
+		for (TimerTask& task : expired)
+			ready.push_back(std::move(task));
+		expired.clear();
+
+		if (!ready.empty()) {
+			TimerTask task = std::move(ready.front());
+			ready.pop_front();
+
+			if (!ready.empty())
+				wakeUp.notify_one(); // Another driver can take the next one
+
+			lock.unlock();
+			task();
+			lock.lock();
+			continue;
+		}
+
+		// Sleep until the next tick - or until something is scheduled, when nothing is pending
+		if (wheel.getPendingCount() == 0)
+			wakeUp.wait(lock);
+		else
+			wakeUp.wait_until(lock, start + tick * (wheel.getCurrentTick() + 1));
+	}
+}
+
+TimerHandle Scheduler::scheduleAfter(std::chrono::milliseconds delay, TimerTask task)
+{
+	uint64_t delayTicks = static_cast<uint64_t>(std::max<int64_t>(0, (delay + tick - std::chrono::milliseconds(1)) / tick));
+
+	TimerHandle handle;
+	bool wasIdle = false;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		wasIdle = wheel.getPendingCount() == 0;
+		handle = wheel.schedule(tickNow() + delayTicks, std::move(task));
+	}
+
+	// Drivers with nothing pending sleep until woken
+	if (wasIdle)
+		wakeUp.notify_one();
+
+	return handle;
+}
+
+bool Scheduler::cancel(TimerHandle handle)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	return wheel.cancel(handle);
+}
+
+size_t Scheduler::getPendingCount()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	return wheel.getPendingCount() + ready.size();
+}
+
+void Scheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		stopping = true;
+	}
+	wakeUp.notify_all();
+
+	for (auto& driver : drivers) {
+		if (driver.joinable())
+			driver.join();
+	}
+	drivers.clear();
+
+	std::lock_guard<std::mutex> guard(mutex);
+	ready.clear();
+}
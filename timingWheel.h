@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <array>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+#include "entityPool.h"
+
+using TimerTask = std::function<void()>;
+
+struct ScheduledTimer; // Tag type of timer handles
+using TimerHandle = Handle<ScheduledTimer>;
+
+// Hierarchical timing wheel: four levels of 64 slots, each level a 64 times coarser tick than the
+// one below. A timer goes into the coarsest level whose slot still separates it from now, and is
+// moved one level down when the wheel reaches its slot. Insert and cancel are O(1) (intrusive lists
+// in a node pool), advancing is O(1) per tick plus the timers that cascade or expire.
+//
+// Not thread-safe - the Scheduler serializes access.
+class TimingWheel {
+private:
+	static constexpr int levelBits = 6;
+	static constexpr int slotsPerLevel = 1 << levelBits;
+	static constexpr int levels = 4;
+	static constexpr uint64_t maxDelay = (uint64_t{ 1 } << (levelBits * levels)) - 1; // Further timers wait in the top level and go round again
+
+	struct Node {
+		uint64_t dueTick = 0;
+		uint32_t generation = 0;
+		int32_t previous = -1;
+		int32_t next = -1; // Next node in the slot, or in the free list
+		int32_t slot = -1; // -1 while free
+		TimerTask task;
+	};
+
+	std::vector<Node> nodes;
+	std::array<int32_t, levels * slotsPerLevel> slots;
+	int32_t freeList = -1;
+	size_t pendingCount = 0;
+	uint64_t currentTick = 0;
+
+	void link(int32_t index);
+	void unlink(int32_t index);
+	void release(int32_t index);
+	void cascade(int level);
+
+public:
+	TimingWheel();
+
+	uint64_t getCurrentTick() const { return currentTick; }
+	size_t getPendingCount() const { return pendingCount; }
+
+	// Runs the task once the wheel has advanced to dueTick - a tick not in the future fires on the next tick
+	TimerHandle schedule(uint64_t dueTick, TimerTask task);
+	bool cancel(TimerHandle handle); // False when the timer already fired or was cancelled
+
+	// Moves the wheel to toTick and appends the tasks of every timer that expired on the way
+	void advance(uint64_t toTick, std::vector<TimerTask>& expired);
+};
+
+// Runs tasks at scheduled times on a handful of driver threads around a TimingWheel.
+// Tasks may schedule and cancel other tasks, including rescheduling themselves.
+class Scheduler {
+private:
+	using Clock = std::chrono::steady_clock;
+
+	TimingWheel wheel;
+	std::chrono::milliseconds tick;
+	Clock::time_point start;
+
+	std::vector<std::thread> drivers;
+	std::deque<TimerTask> ready; // Expired tasks not yet picked up by a driver
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	uint64_t tickNow() const { return static_cast<uint64_t>((Clock::now() - start) / tick); }
+	void driverLoop();
+
+public:
+	explicit Scheduler(int numThreads, std::chrono::milliseconds tick = std::chrono::milliseconds(1));
+	~Scheduler();
+
+	Scheduler(const Scheduler&) = delete;
+	Scheduler& operator=(const Scheduler&) = delete;
+
+	TimerHandle scheduleAfter(std::chrono::milliseconds delay, TimerTask task);
+	bool cancel(TimerHandle handle);
+	size_t getPendingCount();
+
+	// Joins the drivers - tasks that have not started yet are dropped. Not to be called from a task.
+	void stop();
+};
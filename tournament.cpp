@@ -0,0 +1,225 @@
+// tournament.cpp : Plays many independent headless arenas at once and aggregates the results.
+//
+// Usage: Tournament [matches] [threads] [warrior,mage,tank,archer weights] [cpu list | all]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <charconv>
+
+#include "arena.h"
+#include "utils.h"
+#include "cpuAffinity.h"
+
+struct MatchConfiguration {
+	int width = 20;
+	int height = 20;
+	int numberOfBots = 50;
+	int numberOfItems = 5;
+	int itemSpawnRounds = 5;
+	int maxRounds = 2000; // Bots that never meet would otherwise play forever
+	ArchetypeMix archetypeMix = evenArchetypeMix;
+	uint32_t baseSeed = 1; // Match i is seeded with baseSeed + i, so a tournament can be replayed
+	std::vector<int> cpus; // Runner i is pinned to cpus[i % cpus.size()] - empty leaves runners floating
+};
+
+// Results of the matches one runner played - merged only after every runner finished
+struct TournamentTotals {
+	int matches = 0;
+	int decided = 0;
+	std::array<long long, static_cast<size_t>(BotArchetype::Count)> entered{};
+	std::array<int, static_cast<size_t>(BotArchetype::Count)> wins{};
+	std::vector<int> rounds;
+	MoveStats moves;
+
+	void merge(const TournamentTotals& other) {
+		matches += other.matches;
+		decided += other.decided;
+		for (size_t i = 0; i < entered.size(); i++) {
+			entered[i] += other.entered[i];
+			wins[i] += other.wins[i];
+		}
+		rounds.insert(rounds.end(), other.rounds.begin(), other.rounds.end());
+		moves.attempts += other.moves.attempts;
+		moves.commits += other.moves.commits;
+		moves.retries += other.moves.retries;
+		moves.conflicts += other.moves.conflicts;
+	}
+};
+
+// Each match owns its arena - the runners share nothing but the index of the next match
+static void runMatches(const MatchConfiguration& config, int runner, int numberOfMatches, std::atomic<int>& nextMatch, TournamentTotals& totals)
+{
+	// A pinned runner builds its arenas itself, so their memory is first touched on its own NUMA node
+	if (!config.cpus.empty()) {
+		pinCurrentThread(config.cpus[runner % config.cpus.size()]);
+		preferLocalMemory();
+	}
+
+	for (int match = nextMatch.fetch_add(1); match < numberOfMatches; match = nextMatch.fetch_add(1))
+	{
+		Arena arena(config.width, config.height, config.numberOfBots, config.numberOfItems,
+			config.archetypeMix, config.baseSeed + static_cast<uint32_t>(match));
+
+		// The runners already keep every core busy
+		arena.setWorkerThreads(1);
+		arena.setSnapshotInterval(0);
+
+		for (const BotSnapshot& bot : arena.getSnapshot()->bots)
+			totals.entered[static_cast<size_t>(bot.archetype)]++;
+
+		LockstepResult result = arena.runLockstep(config.itemSpawnRounds, config.maxRounds);
+
+		totals.matches++;
+		totals.rounds.push_back(result.rounds);
+		if (result.decided) {
+			totals.decided++;
+			totals.wins[static_cast<size_t>(result.winner)]++;
+		}
+
+		MoveStats moves = arena.getMoveStats();
+		totals.moves.attempts += moves.attempts;
+		totals.moves.commits += moves.commits;
+		totals.moves.retries += moves.retries;
+		totals.moves.conflicts += moves.conflicts;
+	}
+}
+
+static void printResults(const MatchConfiguration& config, const TournamentTotals& totals, int numberOfThreads, double seconds)
+{
+	const int width = 20;
+
+	std::cout << std::format("{} matches on {} threads ({}) - {}x{} arena, {} bots, at most {} rounds\n\n",
+		totals.matches, numberOfThreads, config.cpus.empty() ? "floating" : "pinned",
+		config.width, config.height, config.numberOfBots, config.maxRounds);
+
+	std::cout << std::left << std::setw(width) << "Archetype"
+		<< std::setw(width) << "Bots Entered"
+		<< std::setw(width) << "Wins"
+		<< std::setw(width) << "Win Rate %"
+		<< std::setw(width) << "Wins per 100 Bots" << "\n";
+
+	for (size_t i = 0; i < totals.wins.size(); i++)
+	{
+		double winRate = totals.decided > 0 ? 100.0 * totals.wins[i] / totals.decided : 0.0;
+		double winsPerEntry = totals.entered[i] > 0 ? 100.0 * totals.wins[i] / totals.entered[i] : 0.0;
+
+		std::cout << std::setw(width) << archetypeStats[i].name
+			<< std::setw(width) << totals.entered[i]
+			<< std::setw(width) << totals.wins[i]
+			<< std::setw(width) << std::fixed << std::setprecision(1) << winRate
+			<< std::setw(width) << std::fixed << std::setprecision(2) << winsPerEntry << "\n";
+	}
+
+	std::cout << std::format("\nUndecided matches: {} (no survivor or round limit)\n", totals.matches - totals.decided);
+
+	// Match lengths
+	std::vector<int> rounds = totals.rounds;
+	std::sort(rounds.begin(), rounds.end());
+
+	long long totalRounds = 0;
+	for (int round : rounds)
+		totalRounds += round;
+
+	if (!rounds.empty())
+	{
+		auto percentile = [&rounds](double p) { return rounds[static_cast<size_t>(p * (rounds.size() - 1))]; };
+
+		std::cout << std::format("Match length in rounds: mean {:.1f}, min {}, median {}, p95 {}, max {}\n",
+			static_cast<double>(totalRounds) / rounds.size(), rounds.front(), percentile(0.5), percentile(0.95), rounds.back());
+	}
+
+	// Performance counters
+	double commitRate = totals.moves.attempts > 0 ? 100.0 * totals.moves.commits / totals.moves.attempts : 0.0;
+
+	std::cout << std::format("Moves: {} attempted, {} committed ({:.1f}%)\n", totals.moves.attempts, totals.moves.commits, commitRate);
+	std::cout << std::format("Throughput: {:.1f} matches/s, {:.0f} rounds/s in {:.2f} s\n",
+		totals.matches / seconds, totalRounds / seconds, seconds);
+}
+
+// Parses "w,m,t,a" into an archetype mix - false on a malformed or all-zero mix
+static bool parseArchetypeMix(std::string_view text, ArchetypeMix& mix)
+{
+	ArchetypeMix parsed{};
+	int total = 0;
+
+	for (size_t i = 0; i < parsed.size(); i++)
+	{
+		size_t comma = text.find(',');
+		std::string_view field = text.substr(0, comma);
+
+		auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), parsed[i]);
+		if (error != std::errc() || end != field.data() + field.size() || parsed[i] < 0)
+			return false;
+
+		total += parsed[i];
+
+		bool last = i + 1 == parsed.size();
+		if ((comma == std::string_view::npos) != last)
+			return false;
+
+		if (!last)
+			text.remove_prefix(comma + 1);
+	}
+
+	if (total == 0)
+		return false;
+
+	mix = parsed;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	MatchConfiguration config;
+	int numberOfMatches = argc > 1 ? std::atoi(argv[1]) : 1000;
+	int numberOfThreads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+	bool valid = numberOfMatches > 0 && numberOfThreads > 0 && (argc <= 3 || parseArchetypeMix(argv[3], config.archetypeMix));
+
+	if (valid && argc > 4)
+	{
+		std::optional<std::vector<int>> cpus = std::string_view(argv[4]) == "all" ? getAvailableCpus() : parseCpuList(argv[4]);
+		valid = cpus.has_value();
+		if (valid)
+			config.cpus = *cpus;
+	}
+
+	if (!valid)
+	{
+		printColoredText("TOURNAMENT FAILED", Color::Red);
+		std::cout << "Usage: Tournament [matches] [threads] [warrior,mage,tank,archer weights] [cpu list | all]" << std::endl;
+		return 1;
+	}
+
+	// Headless - console logging would dominate every match
+	setLoggingEnabled(false);
+
+	std::atomic<int> nextMatch{ 0 };
+	std::vector<TournamentTotals> runnerTotals(numberOfThreads);
+	std::vector<std::thread> runners;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < numberOfThreads; i++)
+		runners.emplace_back(runMatches, std::cref(config), i, numberOfMatches, std::ref(nextMatch), std::ref(runnerTotals[i]));
+
+	for (auto& runner : runners)
+		runner.join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	TournamentTotals totals;
+	for (const TournamentTotals& runner : runnerTotals)
+		totals.merge(runner);
+
+	printResults(config, totals, numberOfThreads, seconds);
+
+	return 0;
+}
@@ -1,8 +1,22 @@
 #include "utils.h"
 #include <iostream>
+#include <atomic>
 
-void printColoredText(const std::string& message, Color color) {
-    std::string colorCode;
+static std::atomic<bool> loggingEnabled{ true };
+
+void setLoggingEnabled(bool enabled) {
+    loggingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isLoggingEnabled() {
+    return loggingEnabled.load(std::memory_order_relaxed);
+}
+
+void printColoredText(std::string_view message, Color color) {
+    if (!isLoggingEnabled())
+        return;
+
+    const char* colorCode;
 
     switch (color) {
         case Color::Red:     colorCode = "\033[31m"; break;
@@ -1,5 +1,9 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <iostream>
+#include <iterator>
+#include <format>
 
 // Enum for color codes
 enum class Color {
@@ -24,5 +28,19 @@ struct pair_hash {
     }
 };
 
+// Console logging switch - benchmarks and headless runs turn it off
+void setLoggingEnabled(bool enabled);
+bool isLoggingEnabled();
+
 // Function to print colored text using ANSI codes
-void printColoredText(const std::string& message, Color color);
+void printColoredText(std::string_view message, Color color);
+
+// Formats a log line straight into std::cout - no temporary string is built
+template <class... Args>
+void printLine(std::format_string<Args...> fmt, Args&&... args) {
+    if (!isLoggingEnabled())
+        return;
+
+    std::format_to(std::ostreambuf_iterator<char>(std::cout), fmt, std::forward<Args>(args)...);
+    std::cout << std::endl;
+}
@@ -0,0 +1,151 @@
+// viewer.cpp : Watches a running arena through its shared memory state feed (see stateFeed.h).
+// Any number of viewers can attach to one feed - the simulation never waits for them.
+//
+// Usage: Viewer [feed name] [render | stats] [interval ms]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <array>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdlib>
+
+#include "stateFeed.h"
+#include "utils.h"
+
+// Bots are drawn by the lowercase initial of their archetype, items by their symbol
+constexpr std::array<char, static_cast<size_t>(BotArchetype::Count)> archetypeSymbols = { 'w', 'm', 't', 'a' };
+
+constexpr int maxRenderWidth = 100;
+constexpr int maxRenderHeight = 40;
+constexpr auto attachTimeout = std::chrono::seconds(10);
+
+static char getCellSymbol(uint8_t cell)
+{
+	if (cell >= feedItemCell && cell < feedItemCell + static_cast<int>(ItemType::Count))
+		return itemSymbols[cell - feedItemCell][0];
+	if (cell >= feedBotCell && cell < feedBotCell + static_cast<int>(BotArchetype::Count))
+		return archetypeSymbols[cell - feedBotCell];
+	return '.';
+}
+
+// Top left corner of the arena, as much as fits a terminal
+static void renderFrame(const FeedFrame& frame)
+{
+	int width = std::min(frame.width, maxRenderWidth);
+	int height = std::min(frame.height, maxRenderHeight);
+
+	std::string board = std::format("\033[H\033[2JFrame {} - {}x{} arena, {} bots, {} items\n\n",
+		frame.version, frame.width, frame.height, frame.bots.size(), frame.itemCount);
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++)
+			board += getCellSymbol(frame.cell(x, y));
+		board += '\n';
+	}
+
+	if (width < frame.width || height < frame.height)
+		board += std::format("\n(showing {}x{} of {}x{})\n", width, height, frame.width, frame.height);
+
+	std::cout << board << std::flush;
+}
+
+static void printFrameStats(const FeedFrame& frame)
+{
+	const int width = 20;
+
+	struct ArchetypeTotals {
+		int bots = 0;
+		long long health = 0;
+		int buffed = 0;
+	};
+	std::array<ArchetypeTotals, static_cast<size_t>(BotArchetype::Count)> totals{};
+
+	for (const FeedBot& bot : frame.bots) {
+		if (bot.archetype >= totals.size())
+			continue;
+
+		ArchetypeTotals& archetype = totals[bot.archetype];
+		archetype.bots++;
+		archetype.health += bot.health;
+		for (uint8_t buffs : bot.buffs) {
+			if (buffs > 0) {
+				archetype.buffed++;
+				break;
+			}
+		}
+	}
+
+	std::cout << std::format("\nFrame {} - {} bots, {} items\n", frame.version, frame.bots.size(), frame.itemCount);
+	std::cout << std::left << std::setw(width) << "Archetype"
+		<< std::setw(width) << "Bots"
+		<< std::setw(width) << "Mean Health"
+		<< std::setw(width) << "Buffed" << "\n";
+
+	for (size_t i = 0; i < totals.size(); i++) {
+		double meanHealth = totals[i].bots > 0 ? static_cast<double>(totals[i].health) / totals[i].bots : 0.0;
+
+		std::cout << std::setw(width) << archetypeStats[i].name
+			<< std::setw(width) << totals[i].bots
+			<< std::setw(width) << std::fixed << std::setprecision(1) << meanHealth
+			<< std::setw(width) << totals[i].buffed << "\n";
+	}
+	std::cout << std::flush;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string name = argc > 1 ? argv[1] : defaultStateFeed;
+	std::string_view mode = argc > 2 ? argv[2] : "render";
+	int interval = argc > 3 ? std::atoi(argv[3]) : 100;
+
+	if ((mode != "render" && mode != "stats") || interval <= 0) {
+		printColoredText("VIEWER FAILED", Color::Red);
+		std::cout << "Usage: Viewer [feed name] [render | stats] [interval ms]" << std::endl;
+		return 1;
+	}
+
+	// The viewer may be started before the arena
+	auto deadline = std::chrono::steady_clock::now() + attachTimeout;
+	std::optional<StateFeedReader> reader;
+	reader.emplace(name);
+	while (!reader->isOpen() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		reader.emplace(name);
+	}
+
+	if (!reader->isOpen()) {
+		printColoredText("VIEWER FAILED", Color::Red);
+		std::cout << "No state feed named " << name << " - run Project with publishFeed set" << std::endl;
+		return 1;
+	}
+
+	FeedFrame frame;
+	uint64_t shownVersion = 0;
+
+	while (true) {
+		// Checked first - a frame read after the flag is set is the final one
+		bool finished = reader->isFinished();
+
+		if (reader->read(frame) && frame.version != shownVersion) {
+			shownVersion = frame.version;
+			if (mode == "render")
+				renderFrame(frame);
+			else
+				printFrameStats(frame);
+		}
+
+		if (finished)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+	}
+
+	printColoredText("GAME OVER", Color::Green);
+
+	return 0;
+}